@@ -1,16 +1,20 @@
 #pragma once
 #include <array>
+#include <bit>
+#include <cstddef>
 #include <cstdint>
-#include <forward_list>
-#include <memory>
+#include <span>
 #include <stdexcept>
 #include <string>
 #include <vector>
 
-#include "chess/board/magicBitboards.hpp"
+#include "chess/board/sliders.hpp"
 #include "chess/board/state.hpp"
 #include "chess/move.hpp"
+#include "chess/moveList.hpp"
 #include "chess/piece.hpp"
+#include "chess/position.hpp"
+#include "chess/zobrist.hpp"
 
 #ifdef DEBUG
 namespace Debugger {
@@ -19,7 +23,10 @@ class Game;
 #endif
 
 namespace Chess {
+class MovePicker;
+
 class Board {
+  friend MovePicker;
 
 #ifdef DEBUG
   friend Debugger::Game;
@@ -69,9 +76,39 @@ public:
     return piece.piece - Piece::Pawn;
   }
 
+  /// @brief material key of a number of pieces, 4 bits per piece type and color
+  /// adding up the keys of every piece on the board gives a key that identifies its material
+  inline static constexpr uint64_t materialKey(Piece::Type type, Piece::Color color, uint64_t count = 1) {
+    return count << (pieceToIndex(type, color) * 4);
+  }
+
+  /// @brief classes of legal moves the generators can be asked for
+  enum MoveGenType : uint8_t {
+    // every legal move
+    GenerateAll,
+    // captures (including en passant) and promotions
+    GenerateCaptures,
+    // everything else: non-capturing, non-promoting moves and castling
+    GenerateQuiets,
+    // every legal move while in check, nothing otherwise
+    GenerateEvasions,
+    // quiet moves that give check, directly or by discovery (castling into check excluded)
+    GenerateQuietChecks,
+  };
+
   static const std::array<std::array<uint64_t, 64>, 2> pawnAttacks;
   static const std::array<uint64_t, 64> knightAttacks;
   static const std::array<uint64_t, 64> kingAttacks;
+  /// @brief squares strictly between two squares on a shared rank, file or diagonal (0 if not aligned)
+  static const std::array<std::array<uint64_t, 64>, 64> squaresBetween;
+  /// @brief the whole rank, file or diagonal two squares share (0 if not aligned)
+  static const std::array<std::array<uint64_t, 64>, 64> squaresInLine;
+
+  /// @brief load the sliding piece tables, if the backend keeps them in an asset (magic does)
+  /// call once before making any boards
+  /// @param assetDirectory directory the assets are in, with a trailing slash ("romfs:/" on the 3DS)
+  /// @throws std::runtime_error if the tables couldn't be loaded
+  static void loadSliderTables(const std::string &assetDirectory);
 
   /// @brief create a board from FEN string
   /// @param fen FEN string to parse
@@ -81,139 +118,139 @@ public:
 
 private:
   struct PieceIndex {
-    /// @brief piece index entry; singly linked list
-    struct Entry {
-      uint8_t square;
-      Entry *next;
-      Entry(uint8_t square) : square{square}, next{nullptr} {}
-    };
-
-    PieceIndex() {
-      for (int i{0}; i < 12; i++) {
-        entryRoots[i] = nullptr;
-      }
+    /// @brief most pieces of one type a side can have: 2 originals + 8 promoted pawns
+    static constexpr uint8_t maxPieces{10};
+
+    /// @brief get the squares of every piece of a type
+    /// @param type type of piece to get the squares for
+    /// @param color color of piece to get the squares for
+    /// @return the squares, in no particular order
+    inline std::span<const uint8_t> getSquares(Piece::Type type, Piece::Color color) const {
+      const int index = pieceToIndex(type, color);
+      return {squares[index], counts[index]};
     }
-
-    /// @brief get pointer to first entry in piece index
-    /// @param piece piece to get the index for
-    /// @return pointer to the first index entry
-    inline const Entry *getIndex(Piece::Type type, Piece::Color color) const {
-      return entryRoots[pieceToIndex(type, color)];
+    inline std::span<const uint8_t> getSquares(const Piece &piece) const {
+      const int index = pieceToIndex(piece);
+      return {squares[index], counts[index]};
     }
-    inline const Entry *getIndex(const Piece &piece) const { return entryRoots[pieceToIndex(piece)]; }
-    /// @brief get a specific entry in the piece index
-    /// @param piece piece to retrieve the entry for
-    /// @param square square to look for in index
-    /// @return reference to that specific entry
-    inline Entry &getEntry(const Piece &piece, uint8_t square) {
-      Entry *entry{entryRoots[pieceToIndex(piece)]};
-      while (entry && entry->square != square)
-        entry = entry->next;
-      if (!entry)
-        throw std::runtime_error("requesting entry that does not exist");
-      return *entry;
+
+    /// @brief move an entry in the piece index to another square
+    /// @param piece piece that is moving
+    /// @param square square the piece is on
+    /// @param destination square the piece moves to
+    inline void moveEntry(const Piece &piece, uint8_t square, uint8_t destination) {
+      slots[destination] = slots[square];
+      squares[pieceToIndex(piece)][slots[destination]] = destination;
     }
 
     /// @brief remove an entry from the piece index
     /// @param piece piece index to remove from
     /// @param square square to remove from piece index
     inline void popEntry(const Piece &piece, uint8_t square) {
-      Entry **entryRoot{&(entryRoots[pieceToIndex(piece)])};
+      const int index = pieceToIndex(piece);
 
 #ifdef DEBUG
-      if ((*entryRoot) == nullptr)
+      if (counts[index] == 0 || squares[index][slots[square]] != square)
         throw std::runtime_error("popping piece from square that does not exist");
 #endif
 
-      if ((*entryRoot)->square == square) {
-        // entry root is the node to delete
-        Entry *toDelete{*entryRoot};
-        *entryRoot = toDelete->next;
-        delete toDelete;
-      } else {
-        // start from root, iterate until the next entry is the square we want
-        Entry *entry{*entryRoot};
-        while (entry->next->square != square)
-          entry = entry->next;
-        // store pointer to entry to delete
-        Entry *toDelete = entry->next;
-        // unlink from list
-        entry->next = toDelete->next;
-        delete toDelete;
-      }
+      // fill the hole with the last entry, order doesn't matter
+      const uint8_t last = squares[index][--counts[index]];
+      squares[index][slots[square]] = last;
+      slots[last] = slots[square];
+      materialKey -= uint64_t{1} << (index * 4);
     }
 
     /// @brief add an entry to the piece index
     /// @param piece piece index to add to
     /// @param square square to place in the index
     inline void addEntry(const Piece &piece, uint8_t square) {
-      Entry **entryRoot{&(entryRoots[pieceToIndex(piece)])};
-      if (*entryRoot == nullptr)
-        // index root is empty
-        *entryRoot = new Entry(square);
-      else {
-        Entry *entry{*entryRoot};
-        while (entry->next != nullptr)
-          entry = entry->next;
-        entry->next = new Entry(square);
-      }
+      const int index = pieceToIndex(piece);
+
+      // checked in release builds too, the squares list has no room past maxPieces
+      if (counts[index] >= maxPieces) [[unlikely]]
+        throw std::runtime_error("too many pieces of one type");
+
+      slots[square] = counts[index];
+      squares[index][counts[index]++] = square;
+      materialKey += uint64_t{1} << (index * 4);
     }
 
+    /// @brief sum of Board::materialKey for every piece on the board
+    inline uint64_t getMaterialKey() const { return materialKey; }
+
   private:
-    Entry *entryRoots[12]{nullptr};
+    /// @brief squares of each piece type, only [0, count) is in use
+    uint8_t squares[12][maxPieces]{};
+    uint8_t counts[12]{};
+    /// @brief position of the piece on each square in its squares list
+    uint8_t slots[64]{};
+    uint64_t materialKey{0};
   };
 
-  /// @brief helper object to manage state and history of the board
-  BoardUtils::StateHistory state;
+  using CheckState = BoardUtils::State::CheckState;
+  /// @brief get check and pin state for the side to move, working it out if this position hasn't yet
+  /// @tparam currentTurn color of the side to move
+  template <Piece::Color currentTurn> inline const CheckState &getCheckState() const {
+    CheckState &checkState = state.getCurrentState().checkState;
+    if (checkState.computed)
+      return checkState;
 
-  bool inCheck{false};
-  std::unique_ptr<uint64_t> checkMask{nullptr};
-  std::unique_ptr<uint64_t> pinMask{nullptr};
-  void refreshEphermalState() {
     const uint64_t occupancy{bitboards.getAllPiecesBitboard()};
-    const Piece::Color currentTurn{whiteMove() ? Piece::White : Piece::Black};
-    const uint8_t &kingSquare{pieceIndex.getIndex(Piece::King, currentTurn)->square};
-    const uint64_t calculatedCheckMask = attacksToSquare(occupancy, kingSquare, currentTurn);
-
-    inCheck = calculatedCheckMask != 0;
-    if (inCheck) {
-      checkMask = std::make_unique<uint64_t>(calculatedCheckMask);
-      // TODO - calculate pin mask
-      pinMask = nullptr;
-    } else {
-      checkMask = nullptr;
-      pinMask = nullptr;
-    }
+    const uint8_t kingSquare{pieceIndex.getSquares(Piece::King, currentTurn)[0]};
+    const uint64_t checkers = attacksToSquare<currentTurn>(occupancy, kingSquare);
+
+    checkState.checkers = checkers;
+    // single check - capture the checker or block the line to it
+    // double check - only the king can move, so nothing else may go anywhere
+    if (!checkers)
+      checkState.checkMask = ~0ull;
+    else if (std::has_single_bit(checkers))
+      checkState.checkMask = checkers | squaresBetween[kingSquare][std::countr_zero(checkers)];
+    else
+      checkState.checkMask = 0;
+    checkState.pinned = getPinnedPieces<currentTurn>(occupancy, kingSquare);
+    checkState.computed = true;
+    return checkState;
   }
 
-#pragma region pieces
+  /// @brief squares a piece of the side to move may land on without leaving the king in check
+  /// @tparam color color of the piece
+  /// @param square square the piece is on
+  /// @return check mask, narrowed down to the pin ray if the piece is pinned
+  template <Piece::Color color> inline uint64_t legalTargetMask(uint8_t square) const {
+    const CheckState &checkState = getCheckState<color>();
+    uint64_t mask = checkState.checkMask;
+    if (checkState.pinned & bitmaskForSquare(square))
+      mask &= squaresInLine[std::countr_zero(bitboards.getBitboard(Piece::King, color))][square];
+    return mask;
+  }
 
-  /// @brief the great chessboard, 8 rows and 8 column
-  /// @note to discuss - do we need this representation?
-  /// theoretically, bitboards and piece indexes give all the info we need
-  Piece board[64];
+#pragma region pieces
 
-  /// @brief structure for accessing and modifying pieces indices
-  PieceIndex pieceIndex;
+  // data members are laid out by how hot they are. bitboards are read by every move generator and
+  // attack lookup and take up the first two cache lines of the board. the state history's counters and
+  // the pointer to the current state (check state, en passant, hash) fill the third, the mailbox the
+  // fourth, and the piece index comes last. the states themselves live on the heap, so a board is
+  // cheap to copy
+  static constexpr size_t cacheLineSize{64};
 
   /// @brief structure for accessing bitboards for all pieces
-  struct Bitboards {
-    /// @brief get a reference to a bitboard with piece type and color
+  /// occupancy of each color and of the whole board is kept up to date alongside the piece bitboards,
+  /// so the only way to change a bitboard is through toggle
+  struct alignas(cacheLineSize) Bitboards {
+    /// @brief get a bitboard with piece type and color
     /// @param type type of piece to retrieve bitboard for
     /// @param color color of piece to retrieve bitboard for
-    /// @return reference to the bitboard for that piece
-    uint64_t &getBitboard(const Piece::Type &type, const Piece::Color &color) {
+    /// @return the bitboard for that piece
+    const uint64_t &getBitboard(const Piece::Type &type, const Piece::Color &color) const {
       // piece type - rook = values 0-6 -> *2 to get even values 0-12
       // add color to get odd indexes for black
       return bitboards[pieceToIndex(type, color)];
     }
-    const uint64_t &getBitboard(const Piece::Type &type, const Piece::Color &color) const {
-      return bitboards[pieceToIndex(type, color)];
-    }
-    /// @brief get a reference to a bitboard for a certain piece
+    /// @brief get a bitboard for a certain piece
     /// @param piece piece to retrieve the bitboard for
-    /// @return reference to the bitboard for the piece
-    uint64_t &getBitboard(const Piece &piece) { return bitboards[pieceToIndex(piece)]; }
+    /// @return the bitboard for the piece
     const uint64_t &getBitboard(const Piece &piece) const { return bitboards[pieceToIndex(piece)]; }
 
     /// @brief get a bitboard of both colors of piece type
@@ -226,45 +263,70 @@ private:
       return bitboards[pieceToIndex(piece.type(), Piece::White)] | bitboards[pieceToIndex(piece.type(), Piece::Black)];
     }
 
-    /// @brief calculate a bitboard for all white pieces
+    /// @brief get a bitboard for all white pieces
     /// @return bitboard of all white pieces
-    uint64_t getWhitePiecesBitboard() const {
-      uint64_t bitboard{0};
-      for (int i{0}; i < 12; i += 2) {
-        bitboard |= bitboards[i];
-      }
-      return bitboard;
-    }
-    /// @brief calculate bitboard for all black pieces
+    uint64_t getWhitePiecesBitboard() const { return colorOccupancy[Piece::White]; }
+    /// @brief get a bitboard for all black pieces
     /// @return bitboard of all black pieces
-    uint64_t getBlackPiecesBitboard() const {
-      uint64_t bitboard{0};
-      for (int i{1}; i < 12; i += 2) {
-        bitboard |= bitboards[i];
-      }
-      return bitboard;
-    }
-    /// @brief calculate bitboard for all pieces
+    uint64_t getBlackPiecesBitboard() const { return colorOccupancy[Piece::Black]; }
+    /// @brief get a bitboard for all pieces of one color
+    /// @tparam color color of pieces
+    /// @return bitboard of all pieces of that color
+    template <Piece::Color color> uint64_t getPiecesBitboard() const { return colorOccupancy[color]; }
+    /// @brief get a bitboard for all pieces
     /// @return bitboard of all pieces
-    uint64_t getAllPiecesBitboard() const {
-      uint64_t bitboard{0};
-      for (int i{0}; i < 12; i++) {
-        bitboard |= bitboards[i];
-      };
-      return bitboard;
+    uint64_t getAllPiecesBitboard() const { return occupancy; }
+
+    /// @brief flip squares of a piece's bitboard, along with the occupancy bitboards
+    /// @param piece piece to toggle the squares of
+    /// @param squares bitmask of squares to set if empty, or clear if set
+    inline void toggle(const Piece &piece, uint64_t squares) {
+      bitboards[pieceToIndex(piece)] ^= squares;
+      colorOccupancy[piece.color()] ^= squares;
+      occupancy ^= squares;
     }
 
   private:
     uint64_t bitboards[12]{0};
+    uint64_t colorOccupancy[2]{0};
+    uint64_t occupancy{0};
   } bitboards;
 
+  /// @brief helper object to manage state and history of the board
+  BoardUtils::StateHistory state;
+
+  /// @brief the great chessboard, 8 rows and 8 column
+  /// @note to discuss - do we need this representation?
+  /// theoretically, bitboards and piece indexes give all the info we need
+  Piece board[64];
+
+  /// @brief structure for accessing and modifying pieces indices
+  PieceIndex pieceIndex;
+
+  static_assert(sizeof(Bitboards) == 2 * cacheLineSize, "bitboards should fill exactly two cache lines");
+  static_assert(sizeof(BoardUtils::StateHistory) == cacheLineSize, "the state history should fill one cache line");
+  static_assert(sizeof(Piece) == 1 && sizeof(board) == cacheLineSize, "the mailbox should fill one cache line");
+  static_assert(sizeof(PieceIndex) <= 4 * cacheLineSize, "the piece index should stay within four cache lines");
+
+  /// @brief never called, holds the placement checks - offsetof needs the class to be complete
+  static constexpr void checkLayout() {
+    static_assert(offsetof(Board, bitboards) == 0, "bitboards should open the board");
+    static_assert(offsetof(Board, state) == 2 * cacheLineSize,
+                  "the current state pointer should be in the cache line after the bitboards");
+    static_assert(offsetof(Board, board) == 3 * cacheLineSize, "the mailbox should follow the state history");
+  }
+
+  // every piece change below is also hashed into the current state, so the state for a move
+  // has to be pushed before its pieces move, and popped only after they have been put back
+
   /// @brief move a piece in the board array and corresponding bitboard and pieceindex
   /// @param piece reference to piece to move
   /// @param target square the piece is on
   /// @param destination square to move the piece to
   inline void movePiece(const Piece &piece, unsigned char square, unsigned char destination) {
-    pieceIndex.getEntry(piece, square).square = destination;
-    bitboards.getBitboard(piece) ^= bitmaskForSquare(square) | bitmaskForSquare(destination);
+    pieceIndex.moveEntry(piece, square, destination);
+    bitboards.toggle(piece, bitmaskForSquare(square) | bitmaskForSquare(destination));
+    state.toggleHash(Zobrist::pieceKey(piece, square) ^ Zobrist::pieceKey(piece, destination));
     board[destination] = piece;
     board[square] = Piece::Empty;
   }
@@ -276,7 +338,8 @@ private:
     // remove entry in piece index
     pieceIndex.popEntry(piece, square);
     // unset bit in bitboard
-    bitboards.getBitboard(piece) &= ~bitmaskForSquare(square);
+    bitboards.toggle(piece, bitmaskForSquare(square));
+    state.toggleHash(Zobrist::pieceKey(piece, square));
     // remove piece from board array
     board[square] = Piece::Empty;
   }
@@ -286,7 +349,8 @@ private:
   /// @param square square to summon the piece on
   inline void summonPiece(const Piece &piece, unsigned char square) {
     pieceIndex.addEntry(piece, square);
-    bitboards.getBitboard(piece) |= bitmaskForSquare(square);
+    bitboards.toggle(piece, bitmaskForSquare(square));
+    state.toggleHash(Zobrist::pieceKey(piece, square));
     board[square] = piece;
   }
 
@@ -302,46 +366,123 @@ private:
 
     // remove piece from initial bitboard
     pieceIndex.popEntry(piece, square);
-    bitboards.getBitboard(piece) &= ~bitmaskForSquare(square);
+    bitboards.toggle(piece, bitmaskForSquare(square));
     board[square] = Piece::Empty;
 
     pieceIndex.addEntry(newPiece, destination);
-    bitboards.getBitboard(newPiece) |= bitmaskForSquare(destination);
+    bitboards.toggle(newPiece, bitmaskForSquare(destination));
     board[destination] = newPiece;
+
+    state.toggleHash(Zobrist::pieceKey(piece, square) ^ Zobrist::pieceKey(newPiece, destination));
   }
 
 #pragma region attacks/pins
 
   /// @brief get pieces that attack given square (i.e. get the knight
   /// that needs capturing as it is giving check)
+  /// @tparam kingColor color of the side being attacked
   /// @param occupancy occupancy bitboard
   /// @param square square to check for attackers on
   /// @return bitboard of all attackers
-  uint64_t attacksToSquare(uint64_t occupancy, uint8_t square, Piece::Color kingColor) const;
+  template <Piece::Color kingColor> uint64_t attacksToSquare(uint64_t occupancy, uint8_t square) const;
+  inline uint64_t attacksToSquare(uint64_t occupancy, uint8_t square, Piece::Color kingColor) const {
+    return kingColor == Piece::White ? attacksToSquare<Piece::White>(occupancy, square)
+                                     : attacksToSquare<Piece::Black>(occupancy, square);
+  }
 
   inline bool squareAttacked(uint64_t occupancy, uint8_t square, Piece::Color kingColor) const {
     return attacksToSquare(occupancy, square, kingColor) != 0;
   }
 
-  /// @brief get pin mask (pinned piece)
-  /// @param occupancy
-  /// @param square
-  /// @return
-  uint64_t getPinMask(uint64_t occupancy, uint8_t square) const;
+  /// @brief calculate a map of every square the given side attacks
+  /// @tparam color color of the attacking side
+  /// @param occupancy occupancy bitboard (remove the enemy king to see through it)
+  /// @return bitboard of all attacked squares
+  template <Piece::Color color> uint64_t attackedSquares(uint64_t occupancy) const;
+
+  /// @brief get the lone pieces standing between a king and the sliders aimed at it
+  /// @tparam sniperColor color of the sliders
+  /// @param occupancy occupancy bitboard
+  /// @param kingSquare square of the king the sliders are aimed at
+  /// @return bitboard of pieces of either color that are the only thing between a slider and the king
+  template <Piece::Color sniperColor> uint64_t getSliderBlockers(uint64_t occupancy, uint8_t kingSquare) const;
+
+  /// @brief get the pieces pinned to a king by enemy sliders
+  /// @tparam kingColor color of the king
+  /// @param occupancy occupancy bitboard
+  /// @param kingSquare square of the king pieces are pinned to
+  /// @return bitboard of all pinned pieces
+  template <Piece::Color kingColor> inline uint64_t getPinnedPieces(uint64_t occupancy, uint8_t kingSquare) const {
+    return getSliderBlockers<!kingColor>(occupancy, kingSquare) & bitboards.getPiecesBitboard<kingColor>();
+  }
+
+  /// @brief get our pieces standing between one of our sliders and the enemy king
+  /// @tparam color color of the side giving check
+  /// @param occupancy occupancy bitboard
+  /// @param enemyKingSquare square of the king that would be checked
+  /// @return bitboard of every piece that gives a discovered check by moving off its line
+  template <Piece::Color color>
+  inline uint64_t getDiscoveredCheckCandidates(uint64_t occupancy, uint8_t enemyKingSquare) const {
+    return getSliderBlockers<color>(occupancy, enemyKingSquare) & bitboards.getPiecesBitboard<color>();
+  }
+
+  /// @brief generate moves for a set of pawns at once by shifting the whole bitboard
+  /// @param moves list to append moves to
+  /// @param pawns bitboard of pawns to generate moves for
+  template <Piece::Color color, MoveGenType type> void generatePawnMoves(MoveList &moves, uint64_t pawns) const;
+  /// @brief generate pawn moves for a set of pawns that all share a target mask
+  template <Piece::Color color, MoveGenType type>
+  void generatePawnMoves(MoveList &moves, uint64_t pawns, uint64_t targetMask) const;
+
+  /// @brief check that an en passant capture doesn't expose the king
+  template <Piece::Color color> bool enPassantIsLegal(uint8_t start, uint8_t end) const;
+  /// @brief add an en passant capture if it doesn't expose the king
+  template <Piece::Color color> void addEnPassantIfLegal(MoveList &moves, uint8_t start, uint8_t end) const;
+
+  /// @brief check castling rights, and that the path is empty and safe
+  /// @param blockers occupancy bitboard
+  /// @param attacked squares attacked by the enemy
+  template <Piece::Color color> bool canCastleKingside(uint64_t blockers, uint64_t attacked) const;
+  template <Piece::Color color> bool canCastleQueenside(uint64_t blockers, uint64_t attacked) const;
+
+  template <Piece::Color color, MoveGenType type> void getLegalPawnMoves(MoveList &moves, unsigned char square) const;
+  template <Piece::Color color, MoveGenType type> void getLegalRookMoves(MoveList &moves, unsigned char square) const;
+  template <Piece::Color color, MoveGenType type>
+  void getLegalKnightMoves(MoveList &moves, unsigned char square) const;
+  template <Piece::Color color, MoveGenType type>
+  void getLegalBishopMoves(MoveList &moves, unsigned char square) const;
+  template <Piece::Color color, MoveGenType type> void getLegalQueenMoves(MoveList &moves, unsigned char square) const;
+  template <Piece::Color color, MoveGenType type> void getLegalKingMoves(MoveList &moves, unsigned char square) const;
+
+  template <Piece::Color color> void generateLegalMovesForSquare(MoveList &moves, uint8_t square) const;
+  template <Piece::Color color, MoveGenType type> void generateLegalMoves(MoveList &moves) const;
+  template <Piece::Color color> void generateLegalMoves(MoveList &moves, MoveGenType type) const;
+  /// @brief every square the piece of the side to move on a square can move to
+  /// @tparam legal whether to respect checks and pins, or only give pseudo legal targets
+  template <Piece::Color color, bool legal> uint64_t pieceTargets(uint8_t square) const;
+  template <bool legal> bool validateMove(const Move &move) const;
+
+  /// @brief count the pawn moves of a set of pawns sharing a target mask, promotions count four times
+  template <Piece::Color color> unsigned int countPawnMoves(uint64_t pawns, uint64_t targetMask) const;
+  template <Piece::Color color> unsigned int countLegalMoves() const;
+
+  /// @brief generate the quiet moves that give check, without generating every quiet move
+  template <Piece::Color color> void generateQuietChecks(MoveList &moves) const;
+  /// @brief add a move from the square to every target in the bitboard, all with the same flag
+  static inline void addMoves(MoveList &moves, uint8_t square, uint64_t targets, Move::Flag flag = Move::NoFlag) {
+    for (; targets; targets &= targets - 1)
+      moves.emplace(square, std::countr_zero(targets), flag);
+  }
+
+  template <Piece::Color color> void makeMove(const Move &move);
+  template <Piece::Color color> void unmakeMove();
 
+  // every slider lookup goes through these two, the backend is chosen in cmake (SLIDER_BACKEND)
   inline uint64_t diagonalAttacks(uint64_t occupancy, uint8_t square) const {
-    const uint64_t *movesets = MagicBitboards::diagMovesets[square];
-    const uint64_t &occupancyMask = MagicBitboards::diagMasks[square];
-    const uint64_t &magic = MagicBitboards::diagMagics[square];
-    const uint8_t &shift = MagicBitboards::diagShifts[square];
-    return movesets[((occupancy & occupancyMask) * magic) >> shift];
+    return Sliders::diagonalAttacks(occupancy, square);
   }
   inline uint64_t orthogonalAttacks(uint64_t occupancy, uint8_t square) const {
-    const uint64_t *movesets = MagicBitboards::orthMovesets[square];
-    const uint64_t &occupancyMask = MagicBitboards::orthMasks[square];
-    const uint64_t &magic = MagicBitboards::orthMagics[square];
-    const uint8_t &shift = MagicBitboards::orthShifts[square];
-    return movesets[((occupancy & occupancyMask) * magic) >> shift];
+    return Sliders::orthogonalAttacks(occupancy, square);
   }
 
 #pragma region getters
@@ -355,20 +496,45 @@ public:
   bool canWhiteCastleQueenside() const { return state.getCurrentState().canWhiteCastleQueenside(); }
   bool canBlackCastleQueenside() const { return state.getCurrentState().canBlackCastleQueenside(); }
 
+  /// @brief get the zobrist hash of the current position
+  uint64_t getHash() const { return state.getCurrentState().getHash(); }
+  /// @brief work out the zobrist hash of the current position from scratch
+  /// @note for checking the incremental hash, use getHash() everywhere else
+  uint64_t computeHash() const;
+
   /// @brief get snapshot of full state history
   const BoardUtils::StateHistory &getStateHistory() const { return state; }
   /// @brief get a vector containing all previous moves made
   const std::vector<Move> getMoveHistory() const { return state.getMoveHistory(); }
+  /// @brief is there a move to unmake, without copying the history out like getMoveHistory()
+  inline bool hasPreviousMove() const { return state.hasPreviousMove(); }
+
+  /// @brief keep moves made from here on on the search stack instead of the game history
+  /// a search may go at most BoardUtils::StateHistory::maxSearchPly moves deep
+  void beginSearch() { state.beginSearch(); }
+  /// @brief stop searching, every move made since beginSearch() must have been unmade
+  void endSearch() { state.endSearch(); }
 
   /// @brief Get the FEN string of the current position
   /// @return FEN string of current position
   std::string getFenString() const;
 
-  inline uint8_t getHalfmove() const { return state.currentHalfmove(); }
+  inline unsigned short getHalfmove() const { return state.currentHalfmove(); }
   inline bool whiteMove() const { return state.currentTurnIsWhite(); }
   inline bool blackMove() const { return state.currentTurnIsBlack(); }
 
-  const bool &isInCheck() const { return inCheck; }
+  bool isInCheck() const {
+    return (whiteMove() ? getCheckState<Piece::White>() : getCheckState<Piece::Black>()).checkers != 0;
+  }
+
+  /// @brief check whether the current position is drawn by repetition, the fifty move rule or
+  /// insufficient material
+  /// @param ply moves made since the root of the search, 0 outside of search. a position seen again
+  /// after the root is already a draw, as the side that repeated it could just keep repeating
+  /// @return whether the position is a draw
+  bool isDraw(int ply = 0) const;
+  /// @brief check whether neither side has enough material left to checkmate
+  bool hasInsufficientMaterial() const;
 
   /// @brief retrieve the piece at the given index
   /// @param index index of the square [0,64)
@@ -399,69 +565,51 @@ public:
   static const std::string initialFenString;
   Board() : Board(initialFenString) {}
 
-  const std::forward_list<Move> getLegalPawnMoves(Piece::Color color, unsigned char square) const;
-  const std::forward_list<Move> getLegalRookMoves(Piece::Color color, unsigned char square) const;
-  const std::forward_list<Move> getLegalKnightMoves(Piece::Color color, unsigned char square) const;
-  const std::forward_list<Move> getLegalBishopMoves(Piece::Color color, unsigned char square) const;
-  const std::forward_list<Move> getLegalQueenMoves(Piece::Color color, unsigned char square) const;
-  const std::forward_list<Move> getLegalKingMoves(Piece::Color color, unsigned char square) const;
-
   /// @brief generate legal moves for the specified square
   /// @param square square to generate moves for
-  /// @return vector containing all the moves
-  inline const std::forward_list<Move> getLegalMovesForSquare(unsigned char square) const {
-    const Piece &piece = getPiece(square);
-    switch (piece.type()) {
-    case Piece::Pawn:
-      return getLegalPawnMoves(piece.color(), square);
-    case Piece::Rook:
-      return getLegalRookMoves(piece.color(), square);
-    case Piece::Knight:
-      return getLegalKnightMoves(piece.color(), square);
-    case Piece::Bishop:
-      return getLegalBishopMoves(piece.color(), square);
-    case Piece::Queen:
-      return getLegalQueenMoves(piece.color(), square);
-    case Piece::King:
-      return getLegalKingMoves(piece.color(), square);
-    default:
-      return std::forward_list<Move>{};
-    }
-  }
+  /// @return list containing all the moves
+  MoveList getLegalMovesForSquare(unsigned char square) const;
+
+  /// @brief get every square the piece on a square can legally move to
+  /// much cheaper than getLegalMovesForSquare when only the destinations matter (i.e. drawing them),
+  /// use resolveMove to turn a start and target into a full move
+  /// @param square square of the piece to move
+  /// @return bitboard of legal target squares, 0 if the square isn't a piece of the side to move
+  uint64_t getLegalTargets(unsigned char square) const;
+
+  /// @brief build the move between two squares, working out its flags from the board
+  /// @note the move is not checked for legality
+  /// @param startSquare square the piece moves from
+  /// @param endSquare square the piece moves to
+  /// @param promotion piece type a pawn reaching the last rank promotes to
+  /// @return the move with the flags it would have been generated with
+  Move resolveMove(uint8_t startSquare, uint8_t endSquare, Piece::Type promotion = Piece::Queen) const;
+
+  /// @brief check a move could be made if checks and pins are ignored, without generating anything
+  /// @param move move from anywhere (i.e. the transposition table or a killer slot)
+  /// @return whether the move is pseudo legal in the current position
+  bool isPseudoLegal(const Move &move) const;
+  /// @brief check a move is legal, without generating anything
+  /// @param move move from anywhere (i.e. the transposition table or a killer slot)
+  /// @return whether the move is legal in the current position
+  bool isLegal(const Move &move) const;
+
+  /// @brief generate a subset of the legal moves on the board
+  /// @param type which moves to generate
+  /// @return the requested legal moves at current board state
+  MoveList getLegalMoves(MoveGenType type) const;
+  /// @brief generate a subset of the legal moves on the board into an existing list
+  /// @param moves list to append the moves to
+  /// @param type which moves to generate
+  void getLegalMoves(MoveList &moves, MoveGenType type) const;
 
   /// @brief helper function to generate all legal moves on the board
   /// @return all legal moves at current board state
-  inline std::forward_list<Move> getAllLegalMoves() const {
-    std::forward_list<Move> legalMoves;
-    Piece::Color currentTurn{whiteMove() ? Piece::White : Piece::Black};
-
-    for (auto piece{pieceIndex.getIndex(Piece::Pawn, currentTurn)}; piece != nullptr; piece = piece->next) {
-      auto moves = getLegalPawnMoves(currentTurn, piece->square);
-      legalMoves.merge(moves);
-    }
-    for (auto piece{pieceIndex.getIndex(Piece::Rook, currentTurn)}; piece != nullptr; piece = piece->next) {
-      auto moves = getLegalRookMoves(currentTurn, piece->square);
-      legalMoves.merge(moves);
-    }
-    for (auto piece{pieceIndex.getIndex(Piece::Knight, currentTurn)}; piece != nullptr; piece = piece->next) {
-      auto moves = getLegalKnightMoves(currentTurn, piece->square);
-      legalMoves.merge(moves);
-    }
-    for (auto piece{pieceIndex.getIndex(Piece::Bishop, currentTurn)}; piece != nullptr; piece = piece->next) {
-      auto moves = getLegalBishopMoves(currentTurn, piece->square);
-      legalMoves.merge(moves);
-    }
-    for (auto piece{pieceIndex.getIndex(Piece::Queen, currentTurn)}; piece != nullptr; piece = piece->next) {
-      auto moves = getLegalQueenMoves(currentTurn, piece->square);
-      legalMoves.merge(moves);
-    }
-    for (auto piece{pieceIndex.getIndex(Piece::King, currentTurn)}; piece != nullptr; piece = piece->next) {
-      auto moves = getLegalKingMoves(currentTurn, piece->square);
-      legalMoves.merge(moves);
-    }
+  inline MoveList getAllLegalMoves() const { return getLegalMoves(GenerateAll); }
 
-    return legalMoves;
-  }
+  /// @brief count the legal moves on the board without generating them
+  /// @return number of legal moves at current board state
+  unsigned int countLegalMoves() const;
 
   /// @brief make (apply) the move previously generated by getLegalMoves
   /// technically a helper for making moves in search
@@ -469,12 +617,27 @@ public:
   void makeMove(const Move &move);
 
   /// @brief attempt to make a move on the board, checking legality
-  /// @param startSquare
-  /// @param endSquare
+  /// @param startSquare square the piece moves from
+  /// @param endSquare square the piece moves to
+  /// @param promotion piece type a pawn reaching the last rank promotes to
   /// @return whether or not the move could be successfully made
-  bool makeMove(uint8_t startSquare, uint8_t endSquare);
+  bool makeMove(uint8_t startSquare, uint8_t endSquare, Piece::Type promotion = Piece::Queen);
 
   /// @brief unmake the previous move
   void unmakeMove();
+
+  /// @brief pass the turn without moving, for null move pruning
+  /// only the state changes - en passant is cleared and the hash updated, pieces stay where they are
+  /// @note the side to move must not be in check, throws std::runtime_error if it is
+  void makeNullMove();
+  /// @brief unmake a null move made with makeNullMove
+  void unmakeNullMove();
+
+  /// @brief take a compact snapshot of the current position for copy-make search
+  /// @return the current position
+  Position getPosition() const;
 };
+
+static_assert(alignof(Board) == 64, "boards should start on a cache line, with the bitboards");
+static_assert(sizeof(Board) <= 8 * 64, "boards should stay cheap to copy, the states are kept on the heap");
 } // namespace Chess
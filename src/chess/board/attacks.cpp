@@ -1,15 +1,24 @@
 #include <array>
+#include <bit>
 #include <cstdint>
+#include <string>
 
 #include "chess/board.hpp"
 #include "chess/piece.hpp"
 
 namespace Chess {
+void Board::loadSliderTables([[maybe_unused]] const std::string &assetDirectory) {
+#if !defined(PEXT_BITBOARDS) && !defined(LINE_ATTACKS)
+  MagicBitboards::load(assetDirectory + "magicBitboards.bin");
+#endif
+}
+
 #pragma region simple predet
 const std::array<std::array<uint64_t, 64>, 2> Board::pawnAttacks = []() constexpr {
   std::array<std::array<uint64_t, 64>, 2> attacks{0};
 
-  for (uint8_t i{8}; i < 56; i++) {
+  // pawns never stand on the back ranks, but kings do and look up pawn attacks from there
+  for (uint8_t i{0}; i < 64; i++) {
     uint64_t squareBit = bitmaskForSquare(i);
 
     uint64_t whiteForward = squareBit << 8;
@@ -92,29 +101,109 @@ const std::array<uint64_t, 64> Board::kingAttacks = []() constexpr {
   return attacks;
 }();
 
-#pragma region opponent attacks
+#pragma region lines
+
+// rays are walked in every direction from every square, see squaresBetween/squaresInLine
+static constexpr int lineDirections[8][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {-1, -1}, {1, -1}, {-1, 1}};
+
+const std::array<std::array<uint64_t, 64>, 64> Board::squaresBetween = []() constexpr {
+  std::array<std::array<uint64_t, 64>, 64> between{};
+
+  for (uint8_t from{0}; from < 64; from++) {
+    for (const auto &[rowDir, colDir] : lineDirections) {
+      uint64_t ray{0};
+      for (int distance{1}; squareOffsetInBounds(from, rowDir * distance, colDir * distance); distance++) {
+        uint8_t to = squareOffset(from, rowDir * distance, colDir * distance);
+        between[from][to] = ray;
+        ray |= bitmaskForSquare(to);
+      }
+    }
+  }
+
+  return between;
+}();
 
-/// @brief get a mask containing all squares a piece can move to, being pinned
-/// can also be used to get legal squares when king is in check
-/// @param square
-/// @return
-// uint64_t Board::getPinMask(uint8_t square)
-// {
-//   return 0ull;
-// }
+const std::array<std::array<uint64_t, 64>, 64> Board::squaresInLine = []() constexpr {
+  std::array<std::array<uint64_t, 64>, 64> lines{};
+
+  for (uint8_t from{0}; from < 64; from++) {
+    for (int direction{0}; direction < 8; direction += 2) {
+      // each pair of directions in the table is opposite, together they make up the whole line
+      uint64_t line{bitmaskForSquare(from)};
+      for (int side{0}; side < 2; side++) {
+        const auto &[rowDir, colDir] = lineDirections[direction + side];
+        for (int distance{1}; squareOffsetInBounds(from, rowDir * distance, colDir * distance); distance++)
+          line |= bitmaskForSquare(squareOffset(from, rowDir * distance, colDir * distance));
+      }
+
+      for (uint64_t squares{line ^ bitmaskForSquare(from)}; squares; squares &= squares - 1)
+        lines[from][std::countr_zero(squares)] = line;
+    }
+  }
 
-uint64_t Board::attacksToSquare(uint64_t occupancy, uint8_t square, Piece::Color kingColor) const {
+  return lines;
+}();
+
+#pragma region opponent attacks
+
+template <Piece::Color kingColor> uint64_t Board::attacksToSquare(uint64_t occupancy, uint8_t square) const {
+  constexpr Piece::Color enemy = !kingColor;
   uint64_t knights, kings, queensAndRooks, queensAndBishops;
-  knights = bitboards.getBitboard(Piece::Knight, !kingColor);
-  kings = bitboards.getBitboard(Piece::King, !kingColor);
-  queensAndRooks = queensAndBishops = bitboards.getBitboard(Piece::Queen, !kingColor);
-  queensAndRooks |= bitboards.getBitboard(Piece::Rook, !kingColor);
-  queensAndBishops |= bitboards.getBitboard(Piece::Bishop, !kingColor);
-
-  return (pawnAttacks[0][square] & bitboards.getBitboard(Piece::Pawn, Piece::Black)) |
-         (pawnAttacks[1][square] & bitboards.getBitboard(Piece::Pawn, Piece::White)) |
+  knights = bitboards.getBitboard(Piece::Knight, enemy);
+  kings = bitboards.getBitboard(Piece::King, enemy);
+  queensAndRooks = queensAndBishops = bitboards.getBitboard(Piece::Queen, enemy);
+  queensAndRooks |= bitboards.getBitboard(Piece::Rook, enemy);
+  queensAndBishops |= bitboards.getBitboard(Piece::Bishop, enemy);
+
+  // enemy pawns attacking this square sit where our own pawn would attack from it
+  return (pawnAttacks[kingColor][square] & bitboards.getBitboard(Piece::Pawn, enemy)) |
          (knightAttacks[square] & knights) | (kingAttacks[square] & kings) |
          (diagonalAttacks(occupancy, square) & queensAndBishops) |
          (orthogonalAttacks(occupancy, square) & queensAndRooks);
 }
+template uint64_t Board::attacksToSquare<Piece::White>(uint64_t occupancy, uint8_t square) const;
+template uint64_t Board::attacksToSquare<Piece::Black>(uint64_t occupancy, uint8_t square) const;
+
+template <Piece::Color color> uint64_t Board::attackedSquares(uint64_t occupancy) const {
+  // pawns all at once, same shifts as move generation
+  const uint64_t pawns = bitboards.getBitboard(Piece::Pawn, color);
+  uint64_t attacks;
+  if constexpr (color == Piece::White)
+    attacks = ((pawns & ~bitmaskForCol(0)) << 7) | ((pawns & ~bitmaskForCol(7)) << 9);
+  else
+    attacks = ((pawns & ~bitmaskForCol(0)) >> 9) | ((pawns & ~bitmaskForCol(7)) >> 7);
+
+  for (uint64_t knights{bitboards.getBitboard(Piece::Knight, color)}; knights; knights &= knights - 1)
+    attacks |= knightAttacks[std::countr_zero(knights)];
+
+  const uint64_t queens = bitboards.getBitboard(Piece::Queen, color);
+  for (uint64_t bishops{bitboards.getBitboard(Piece::Bishop, color) | queens}; bishops; bishops &= bishops - 1)
+    attacks |= diagonalAttacks(occupancy, std::countr_zero(bishops));
+  for (uint64_t rooks{bitboards.getBitboard(Piece::Rook, color) | queens}; rooks; rooks &= rooks - 1)
+    attacks |= orthogonalAttacks(occupancy, std::countr_zero(rooks));
+
+  return attacks | kingAttacks[std::countr_zero(bitboards.getBitboard(Piece::King, color))];
+}
+template uint64_t Board::attackedSquares<Piece::White>(uint64_t occupancy) const;
+template uint64_t Board::attackedSquares<Piece::Black>(uint64_t occupancy) const;
+
+template <Piece::Color sniperColor> uint64_t Board::getSliderBlockers(uint64_t occupancy, uint8_t kingSquare) const {
+  // sniper sliders that would see the king on an empty board
+  const uint64_t queens = bitboards.getBitboard(Piece::Queen, sniperColor);
+  const uint64_t queensAndRooks = queens | bitboards.getBitboard(Piece::Rook, sniperColor);
+  const uint64_t queensAndBishops = queens | bitboards.getBitboard(Piece::Bishop, sniperColor);
+  uint64_t snipers = (orthogonalAttacks(0, kingSquare) & queensAndRooks) |
+                     (diagonalAttacks(0, kingSquare) & queensAndBishops);
+
+  // a sniper with exactly one piece in the way, of either color, is held back by that piece alone
+  uint64_t blockers{0};
+  for (; snipers; snipers &= snipers - 1) {
+    const uint64_t between = squaresBetween[kingSquare][std::countr_zero(snipers)] & occupancy;
+    if (std::has_single_bit(between))
+      blockers |= between;
+  }
+  return blockers;
+}
+template uint64_t Board::getSliderBlockers<Piece::White>(uint64_t occupancy, uint8_t kingSquare) const;
+template uint64_t Board::getSliderBlockers<Piece::Black>(uint64_t occupancy, uint8_t kingSquare) const;
 } // namespace Chess
@@ -23,17 +23,25 @@ Board::Board(std::string fen) {
 
   // parse board
   int row = 7, col = 0;
+  // pieces of each kind, indexed like pieceToIndex - the piece index only has room for so many
+  int pieceCounts[12]{};
   for (char c : boardPart) {
     if (c == '/') {
       row--;
       col = 0;
+      if (row < 0)
+        throw std::invalid_argument("Invalid FEN string: too many ranks");
     } else if (isdigit(c)) {
       int emptySquares = c - '0';
+      if (col + emptySquares > 8)
+        throw std::invalid_argument("Invalid FEN string: too many squares in a rank");
       for (int i = 0; i < emptySquares; i++) {
         board[row * 8 + col] = Piece::Empty;
         col++;
       }
     } else {
+      if (col >= 8)
+        throw std::invalid_argument("Invalid FEN string: too many squares in a rank");
       const bool isWhite = isupper(c);
       Piece::Color color = isWhite ? Piece::White : Piece::Black;
       Piece::Type type;
@@ -60,6 +68,10 @@ Board::Board(std::string fen) {
         throw std::invalid_argument("Invalid FEN string: unknown piece character");
       }
 
+      const int maxCount = type == Piece::Pawn ? 8 : type == Piece::King ? 1 : PieceIndex::maxPieces;
+      if (++pieceCounts[pieceToIndex(type, color)] > maxCount)
+        throw std::invalid_argument("Invalid FEN string: too many pieces of one kind");
+
       uint8_t squareIndex = square(row, col);
       Piece piece = Piece(color, type);
       summonPiece(piece, squareIndex);
@@ -68,6 +80,10 @@ Board::Board(std::string fen) {
     }
   }
 
+  if (pieceCounts[pieceToIndex(Piece::King, Piece::White)] != 1 ||
+      pieceCounts[pieceToIndex(Piece::King, Piece::Black)] != 1)
+    throw std::invalid_argument("Invalid FEN string: each side needs exactly one king");
+
   // state setup
   int halfmove{0};
   // parse active color
@@ -95,7 +111,7 @@ Board::Board(std::string fen) {
   uint8_t fiftyMoveCounter{0};
   if (!halfmovePart.empty()) {
     int halfmoveClock = std::stoi(halfmovePart);
-    if (halfmoveClock < 0 || halfmoveClock > 50) {
+    if (halfmoveClock < 0 || halfmoveClock > 100) {
       throw std::invalid_argument("Invalid FEN string: invalid halfmove clock");
     }
     fiftyMoveCounter = halfmoveClock;
@@ -198,14 +214,17 @@ std::string Board::getFenString() const {
     fenString.append("-");
   }
 
-  if (!currentState.enPassantAvailable()) {
-    char enPassantFile = currentState.getEnPassantFile();
+  // en passant target square is behind the pawn that just double pushed
+  if (currentState.enPassantAvailable()) {
     fenString.append(" ");
-    fenString.push_back('a' + enPassantFile);
+    fenString.push_back('a' + currentState.getEnPassantFile());
+    fenString.push_back(whiteMove() ? '6' : '3');
+  } else {
+    fenString.append(" -");
   }
 
   std::stringstream stream;
-  stream << " " << currentState.getFiftyMoveCounter() << " " << state.currentFullmove();
+  stream << " " << static_cast<int>(currentState.getFiftyMoveCounter()) << " " << state.currentFullmove();
   fenString.append(stream.str());
 
   return fenString;
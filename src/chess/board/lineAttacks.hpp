@@ -0,0 +1,82 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <cstdint>
+
+/*
+  slider lookups without moveset tables, picked in cmake with SLIDER_BACKEND=lines.
+
+  on the 3DS a magic lookup that misses the cache can cost more than just working the
+  attacks out, so this computes them from the occupancy with a few subtractions:
+
+  - files and diagonals use hyperbola quintessence. for the rays going up the board,
+    o ^ (o - 2r) sets every bit from the slider up to the first blocker. byte swapping
+    mirrors the board vertically, which turns the rays going down into rays going up
+  - ranks can't be mirrored by a byte swap, so they use the obstruction difference -
+    subtracting the highest blocker below the slider from the blockers above it
+
+  the only data is three line masks per square (1.5 KB), instead of ~840 KB of magic movesets.
+*/
+
+namespace Chess::LineAttacks {
+/// @brief lines through a square, not including the square itself
+struct Lines {
+  uint64_t file;
+  uint64_t diagonal;
+  uint64_t antiDiagonal;
+};
+
+inline constexpr std::array<Lines, 64> lines = []() constexpr {
+  std::array<Lines, 64> lines{};
+  for (int square{0}; square < 64; square++) {
+    const int row = square / 8;
+    const int col = square % 8;
+    for (int other{0}; other < 64; other++) {
+      if (other == square)
+        continue;
+      const int otherRow = other / 8;
+      const int otherCol = other % 8;
+      if (otherCol == col)
+        lines[square].file |= 1ull << other;
+      if (otherRow - otherCol == row - col)
+        lines[square].diagonal |= 1ull << other;
+      if (otherRow + otherCol == row + col)
+        lines[square].antiDiagonal |= 1ull << other;
+    }
+  }
+  return lines;
+}();
+
+// std::byteswap is c++23, both gcc (devkitARM included) and clang have the builtin
+inline uint64_t byteswap(uint64_t bitboard) { return __builtin_bswap64(bitboard); }
+
+/// @brief attacks along a line that byte swapping mirrors, so a file or a diagonal
+inline uint64_t hyperbolaQuintessence(uint64_t occupancy, uint64_t line, uint8_t square) {
+  const uint64_t slider = 1ull << square;
+  uint64_t forward = occupancy & line;
+  uint64_t reverse = byteswap(forward);
+  forward -= slider;
+  reverse -= byteswap(slider);
+  return (forward ^ byteswap(reverse)) & line;
+}
+
+/// @brief attacks along the slider's rank
+inline uint64_t rankAttacks(uint64_t occupancy, uint8_t square) {
+  const uint64_t rank = 0xFFull << (square & 56);
+  const uint64_t below = rank & ((1ull << square) - 1);
+  const uint64_t above = rank & (~1ull << square);
+
+  // highest blocker below the slider, or bit 0 when there isn't one
+  const uint64_t lowerBlocker = 0x8000000000000000ull >> std::countl_zero((occupancy & below) | 1);
+  const uint64_t upperBlockers = occupancy & above;
+  return (upperBlockers ^ (upperBlockers - lowerBlocker)) & (below | above);
+}
+
+inline uint64_t orthogonalAttacks(uint64_t occupancy, uint8_t square) {
+  return hyperbolaQuintessence(occupancy, lines[square].file, square) | rankAttacks(occupancy, square);
+}
+inline uint64_t diagonalAttacks(uint64_t occupancy, uint8_t square) {
+  return hyperbolaQuintessence(occupancy, lines[square].diagonal, square) |
+         hyperbolaQuintessence(occupancy, lines[square].antiDiagonal, square);
+}
+} // namespace Chess::LineAttacks
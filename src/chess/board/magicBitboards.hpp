@@ -1,23 +1,92 @@
 #pragma once
+#include <array>
+#include <cstddef>
 #include <cstdint>
+#include <string>
 
 /*
-  the source file that defines these magics are generated by running the
-  magic-generation and magic-conversion utilities.
+  the magics and their movesets come from an asset (assets/magicBitboards.bin), generated
+  by running the magic-generation and magic-conversion utilities.
 
-  current ones are generated by yours truly on my home server over the course
-  of a couple of days, it doesn't take too long to get magics but getting
-  magics that compress the bitboards takes time
+  current ones are plain fancy magics: a square with n bits in its mask gets an n bit index,
+  so its slice of movesets is 2^n long - 800 KiB for rooks and 41 KiB for bishops. the
+  search finds a full set in about a minute and then keeps looking for magics that need
+  a bit fewer, which are rare
+
+  the asset is mapped straight into memory on PC and read from romfs into a single
+  allocation on the 3DS, so new magics don't mean recompiling megabytes of literals.
 */
 
 namespace Chess::MagicBitboards {
-extern const uint64_t orthMasks[64];
-extern const uint64_t orthMagics[64];
-extern const uint8_t orthShifts[64];
-extern const uint64_t *orthMovesets[64];
-
-extern const uint64_t diagMasks[64];
-extern const uint64_t diagMagics[64];
-extern const uint8_t diagShifts[64];
-extern const uint64_t *diagMovesets[64];
+/// @brief lookup data for a single square
+/// everything a lookup needs sits side by side, so it only costs one cache line before the moveset load
+struct alignas(32) Entry {
+  /// @brief squares whose occupancy can block the slider, board edges excluded
+  uint64_t mask;
+  uint64_t magic;
+  /// @brief attacks for every index the magic maps an occupancy to
+  const uint64_t *movesets;
+  uint8_t shift;
+};
+static_assert(sizeof(Entry) == 32, "two entries per cache line, so none straddle two");
+
+/// @brief filled in by load(), everything before that is a null pointer away from a crash
+extern std::array<Entry, 64> orth;
+extern std::array<Entry, 64> diag;
+
+inline uint64_t orthogonalAttacks(uint64_t occupancy, uint8_t square) {
+  const Entry &entry = orth[square];
+  return entry.movesets[((occupancy & entry.mask) * entry.magic) >> entry.shift];
+}
+inline uint64_t diagonalAttacks(uint64_t occupancy, uint8_t square) {
+  const Entry &entry = diag[square];
+  return entry.movesets[((occupancy & entry.mask) * entry.magic) >> entry.shift];
+}
+
+/// @brief load the magics and movesets from the asset, does nothing if they're already loaded
+/// @param path path of the asset
+/// @throws std::runtime_error if the asset can't be read or isn't a valid one
+void load(const std::string &path);
+
+#pragma region asset format
+
+// everything is little endian, the same as both the 3DS and x86
+// header, orth entries, diag entries, orth movesets, diag movesets - every section starts 8 byte aligned
+static constexpr char assetTag[4]{'M', 'B', 'B', 'T'};
+static constexpr uint32_t assetVersion{1};
+
+struct AssetHeader {
+  char tag[4];
+  uint32_t version;
+  /// @brief checksum() of everything after the header
+  uint64_t checksum;
+  /// @brief size of the whole asset, header included
+  uint32_t size;
+  /// @brief byte offsets of each section from the start of the asset
+  uint32_t orthEntries;
+  uint32_t diagEntries;
+  uint32_t orthMovesets;
+  uint32_t diagMovesets;
+  uint32_t reserved{0};
+};
+static_assert(sizeof(AssetHeader) == 40);
+
+struct AssetEntry {
+  uint64_t mask;
+  uint64_t magic;
+  /// @brief index of the square's first moveset in its direction's movesets
+  uint32_t movesetOffset;
+  uint32_t shift;
+};
+static_assert(sizeof(AssetEntry) == 24);
+
+/// @brief cheap rotate-xor checksum, only there to catch a truncated or stale asset
+inline uint64_t checksum(const uint64_t *words, size_t count) {
+  uint64_t sum{0};
+  for (size_t i{0}; i < count; i++)
+    sum = ((sum << 7) | (sum >> 57)) ^ words[i];
+  return sum;
+}
+
+#pragma endregion
 } // namespace Chess::MagicBitboards
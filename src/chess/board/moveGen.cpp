@@ -1,292 +1,600 @@
 #include <bit>
 #include <cstdint>
-#include <forward_list>
 #include <stdexcept>
 
 #include "chess/board.hpp"
 #include "chess/board/state.hpp"
 #include "chess/move.hpp"
+#include "chess/moveList.hpp"
 #include "chess/piece.hpp"
-#include "magicBitboards.hpp"
 
 namespace Chess {
 
 #pragma region pawn moves
 
-const std::forward_list<Move> Board::getLegalPawnMoves(Piece::Color color, uint8_t square) const {
+/// @brief shift a bitboard by a signed square offset
+static constexpr uint64_t shiftBitboard(uint64_t bitboard, int offset) {
+  return offset > 0 ? bitboard << offset : bitboard >> -offset;
+}
+
+/// @brief add a pawn move for every target in the bitboard, start square is
+/// recovered from the offset the pawns were shifted by
+static inline void addPawnMoves(MoveList &moves, uint64_t targets, int offset, Move::Flag flag) {
+  while (targets) {
+    uint8_t target = std::countr_zero(targets);
+    moves.emplace(target - offset, target, flag);
+    targets &= targets - 1;
+  }
+}
+
+/// @brief add all four promotions for every target in the bitboard
+static inline void addPawnPromotions(MoveList &moves, uint64_t targets, int offset, bool capture) {
+  while (targets) {
+    uint8_t target = std::countr_zero(targets);
+    uint8_t start = target - offset;
+    if (capture) {
+      moves.emplace(start, target, Move::RookPromotionCapture);
+      moves.emplace(start, target, Move::KnightPromotionCapture);
+      moves.emplace(start, target, Move::BishopPromotionCapture);
+      moves.emplace(start, target, Move::QueenPromotionCapture);
+    } else {
+      moves.emplace(start, target, Move::RookPromotion);
+      moves.emplace(start, target, Move::KnightPromotion);
+      moves.emplace(start, target, Move::BishopPromotion);
+      moves.emplace(start, target, Move::QueenPromotion);
+    }
+    targets &= targets - 1;
+  }
+}
+
+template <Piece::Color color, Board::MoveGenType type>
+void Board::getLegalPawnMoves(MoveList &moves, uint8_t square) const {
 #ifdef DEBUG
   if (getPiece(square) != Piece(color, Piece::Pawn))
     throw std::runtime_error("creating move for invalid piece");
 #endif
-  const BoardUtils::State &state = getCurrentState();
-  // keep iterator to last move in list, build from bottom up - increment after move added
-  std::forward_list<Move> moves;
-  std::forward_list<Move>::iterator lastMove{moves.before_begin()};
+  generatePawnMoves<color, type>(moves, bitmaskForSquare(square), legalTargetMask<color>(square));
+}
 
-  // square indexes
-  const int forwardDir = color == Piece::White ? 1 : -1;
-  const uint8_t forwardSquare = squareOffset(square, forwardDir, 0);
+template <Piece::Color color, Board::MoveGenType type>
+void Board::generatePawnMoves(MoveList &moves, uint64_t pawns) const {
+  const CheckState &checkState = getCheckState<color>();
+  const uint64_t targetMask = checkState.checkMask;
+  const uint64_t pinnedPawns = pawns & checkState.pinned;
+
+  // unpinned pawns all share the same target mask, pinned ones get their own pin ray
+  generatePawnMoves<color, type>(moves, pawns & ~pinnedPawns, targetMask);
+  for (uint64_t pinned{pinnedPawns}; pinned; pinned &= pinned - 1) {
+    uint8_t square = std::countr_zero(pinned);
+    generatePawnMoves<color, type>(moves, bitmaskForSquare(square), legalTargetMask<color>(square));
+  }
+}
 
-  // bitmasks
-  const uint64_t squareBit = bitmaskForSquare(square);
-  const uint64_t forwardBit = bitmaskForSquare(forwardSquare);
+template <Piece::Color color, Board::MoveGenType type>
+void Board::generatePawnMoves(MoveList &moves, uint64_t pawns, uint64_t targetMask) const {
+  const BoardUtils::State &state = getCurrentState();
 
   const uint64_t blockerBitboard = bitboards.getAllPiecesBitboard();
-  const uint64_t enemyBitboard =
-      color == Piece::White ? bitboards.getBlackPiecesBitboard() : bitboards.getWhitePiecesBitboard();
-  static const uint64_t promotionMask[2] = {bitmaskForRow(7), bitmaskForRow(0)};
-
-  // moving forward, and 2 square first move
-  if (forwardBit & ~blockerBitboard) {
-    // handle promotions if pawn moves to back rank
-    if (forwardBit & promotionMask[color]) {
-      // promotions
-      moves.emplace_after(lastMove, square, forwardSquare, Move::RookPromotion);
-      moves.emplace_after(++lastMove, square, forwardSquare, Move::KnightPromotion);
-      moves.emplace_after(++lastMove, square, forwardSquare, Move::RookPromotion);
-      moves.emplace_after(++lastMove, square, forwardSquare, Move::QueenPromotion);
-      lastMove++;
-    } else {
-      moves.emplace_after(lastMove, square, forwardSquare);
-      lastMove++;
-
-      static const uint64_t startRankMask[2] = {bitmaskForRow(1), bitmaskForRow(6)};
-      if (squareBit & startRankMask[color]) {
-        uint64_t doublePush = squareOffset(forwardSquare, forwardDir, 0);
-        uint64_t doublePushBit = bitmaskForSquare(doublePush);
-        if (doublePushBit & ~blockerBitboard) {
-          moves.emplace_after(lastMove, square, doublePush, Move::Flag::PawnDoubleMove);
-          lastMove++;
-        }
-      }
-    }
-  }
-
-  // check if en passant is possible and if this piece is in position to perform
-  uint64_t enPassantBit{0};
-  if (state.enPassantAvailable()) {
-    // get rank, get files, bit-and it all together
-    uint8_t enPassantFile = state.getEnPassantFile();
-    static uint64_t enPassantRankMask[2] = {bitmaskForRow(6), bitmaskForRow(1)};
-    uint64_t enPassantFileMask = bitmaskForCol(enPassantFile);
-    enPassantBit = enPassantRankMask[color] & enPassantFileMask;
+  const uint64_t enemyBitboard = bitboards.getPiecesBitboard<!color>();
+
+  // offsets from start square to target square, left/right are from white's perspective
+  constexpr int forward = color == Piece::White ? 8 : -8;
+  constexpr int captureLeft = forward - 1;
+  constexpr int captureRight = forward + 1;
+
+  constexpr uint64_t promotionMask = bitmaskForRow(color == Piece::White ? 7 : 0);
+  // rank a pawn lands on after a single push from its start rank
+  constexpr uint64_t doublePushMask = bitmaskForRow(color == Piece::White ? 2 : 5);
+
+  // pushes, pawns on the a/h files can't capture off the edge of the board
+  // double pushes are filtered after the single push, so a blocked first square also blocks the second
+  const uint64_t singlePushes = shiftBitboard(pawns, forward) & ~blockerBitboard;
+  const uint64_t doublePushes = shiftBitboard(singlePushes & doublePushMask, forward) & ~blockerBitboard & targetMask;
+  const uint64_t leftCaptures = shiftBitboard(pawns & ~bitmaskForCol(0), captureLeft) & enemyBitboard & targetMask;
+  const uint64_t rightCaptures =
+      shiftBitboard(pawns & ~bitmaskForCol(7), captureRight) & enemyBitboard & targetMask;
+
+  if constexpr (type != GenerateCaptures) {
+    addPawnMoves(moves, singlePushes & targetMask & ~promotionMask, forward, Move::NoFlag);
+    addPawnMoves(moves, doublePushes, forward * 2, Move::PawnDoubleMove);
   }
 
-  // get attack bitboard
-  const uint64_t &attackMask = pawnAttacks[color][square];
-  uint64_t captureMask = attackMask & enemyBitboard;
-  const bool captureWillPromote = captureMask & promotionMask[color];
-  while (captureMask) {
-    uint8_t captureSquare = std::countr_zero(captureMask);
-    if (captureWillPromote) {
-      moves.emplace_after(lastMove, square, captureSquare, Move::RookPromotionCapture);
-      moves.emplace_after(++lastMove, square, captureSquare, Move::KnightPromotionCapture);
-      moves.emplace_after(++lastMove, square, captureSquare, Move::BishopPromotionCapture);
-      moves.emplace_after(++lastMove, square, captureSquare, Move::QueenPromotionCapture);
-    } else {
-      moves.emplace_after(lastMove, square, captureSquare, Move::Capture);
+  // promotions count as captures, they change material just the same
+  if constexpr (type != GenerateQuiets) {
+    addPawnMoves(moves, leftCaptures & ~promotionMask, captureLeft, Move::Capture);
+    addPawnMoves(moves, rightCaptures & ~promotionMask, captureRight, Move::Capture);
+
+    addPawnPromotions(moves, singlePushes & targetMask & promotionMask, forward, false);
+    addPawnPromotions(moves, leftCaptures & promotionMask, captureLeft, true);
+    addPawnPromotions(moves, rightCaptures & promotionMask, captureRight, true);
+
+    // en passant, target square sits behind the pawn that just double pushed
+    if (state.enPassantAvailable()) {
+      constexpr uint64_t enPassantRankMask = bitmaskForRow(color == Piece::White ? 5 : 2);
+      const uint64_t enPassantBit = enPassantRankMask & bitmaskForCol(state.getEnPassantFile());
+      const uint8_t enPassantSquare = std::countr_zero(enPassantBit);
+      if (shiftBitboard(pawns & ~bitmaskForCol(0), captureLeft) & enPassantBit)
+        addEnPassantIfLegal<color>(moves, enPassantSquare - captureLeft, enPassantSquare);
+      if (shiftBitboard(pawns & ~bitmaskForCol(7), captureRight) & enPassantBit)
+        addEnPassantIfLegal<color>(moves, enPassantSquare - captureRight, enPassantSquare);
     }
-    lastMove++;
-    captureMask &= captureMask - 1;
-  }
-  if (attackMask & enPassantBit) {
-    moves.emplace_after(lastMove, square, std::countr_zero(enPassantBit), Move::EnPassantCapture);
   }
+}
 
-  return moves;
+template <Piece::Color color> bool Board::enPassantIsLegal(uint8_t start, uint8_t end) const {
+  // en passant removes two pieces from the same rank, so neither the check mask or
+  // the pin masks cover it. play it out on the occupancy and look at the king instead
+  const uint8_t captureSquare = squareOffset(end, color == Piece::White ? -1 : 1, 0);
+  const uint64_t occupancy = bitboards.getAllPiecesBitboard() ^ bitmaskForSquare(start) ^ bitmaskForSquare(end) ^
+                             bitmaskForSquare(captureSquare);
+  const uint8_t kingSquare = std::countr_zero(bitboards.getBitboard(Piece::King, color));
+  return (attacksToSquare<color>(occupancy, kingSquare) & ~bitmaskForSquare(captureSquare)) == 0;
 }
 
-#pragma region knight moves
+template <Piece::Color color> void Board::addEnPassantIfLegal(MoveList &moves, uint8_t start, uint8_t end) const {
+  if (enPassantIsLegal<color>(start, end))
+    moves.emplace(start, end, Move::EnPassantCapture);
+}
 
-const std::forward_list<Move> Board::getLegalKnightMoves(Piece::Color color, uint8_t square) const {
-  std::forward_list<Move> moves;
-  std::forward_list<Move>::iterator lastMove{moves.before_begin()};
+#pragma region knight moves
 
+template <Piece::Color color, Board::MoveGenType type>
+void Board::getLegalKnightMoves(MoveList &moves, uint8_t square) const {
   // get moves from precomputed knight attack array
-  uint64_t attacks = knightAttacks[square];
+  uint64_t attacks = knightAttacks[square] & legalTargetMask<color>(square);
   uint64_t blockerBitmask = bitboards.getAllPiecesBitboard();
-  uint64_t captureBitmask =
-      color == Piece::White ? bitboards.getBlackPiecesBitboard() : bitboards.getWhitePiecesBitboard();
-
-  uint64_t movesBitboard = attacks & ~blockerBitmask;
-  while (movesBitboard) {
-    uint8_t moveSquare = std::countr_zero(movesBitboard);
-    moves.emplace_after(lastMove, square, moveSquare);
-    lastMove++;
-    movesBitboard &= movesBitboard - 1;
-  }
-
-  uint64_t capturesBitboard = attacks & captureBitmask;
-  while (capturesBitboard) {
-    uint8_t moveSquare = std::countr_zero(capturesBitboard);
-    moves.emplace_after(lastMove, square, moveSquare, Move::Flag::Capture);
-    lastMove++;
-    capturesBitboard &= capturesBitboard - 1;
-  }
+  uint64_t captureBitmask = bitboards.getPiecesBitboard<!color>();
 
-  return moves;
+  if constexpr (type != GenerateCaptures)
+    addMoves(moves, square, attacks & ~blockerBitmask);
+  if constexpr (type != GenerateQuiets)
+    addMoves(moves, square, attacks & captureBitmask, Move::Capture);
 }
 
 #pragma region bishop moves
 
-const std::forward_list<Move> Board::getLegalBishopMoves(Piece::Color color, uint8_t square) const {
-  std::forward_list<Move> moves;
-  std::forward_list<Move>::iterator lastMove{moves.before_begin()};
-
-  const uint64_t *movesets = MagicBitboards::diagMovesets[square];
-  const uint64_t &occupancyMask = MagicBitboards::diagMasks[square];
-  const uint64_t &magic = MagicBitboards::diagMagics[square];
-  const uint8_t &shift = MagicBitboards::diagShifts[square];
-
+template <Piece::Color color, Board::MoveGenType type>
+void Board::getLegalBishopMoves(MoveList &moves, uint8_t square) const {
   const uint64_t occupancy = bitboards.getAllPiecesBitboard();
-  const uint64_t enemyBitboard =
-      color == Piece::White ? bitboards.getBlackPiecesBitboard() : bitboards.getWhitePiecesBitboard();
-
-  const uint64_t &moveset = movesets[((occupancy & occupancyMask) * magic) >> shift];
-
-  uint64_t moveMoveset = moveset & ~occupancy;
-  while (moveMoveset) {
-    // extract all move positions
-    uint8_t moveSquare = std::countr_zero(moveMoveset);
-    moves.emplace_after(lastMove, square, moveSquare);
-    lastMove++;
-    moveMoveset &= moveMoveset - 1;
-  }
+  const uint64_t enemyBitboard = bitboards.getPiecesBitboard<!color>();
 
-  uint64_t captureMoveset = moveset & enemyBitboard;
-  while (captureMoveset) {
-    uint8_t captureSquare = std::countr_zero(captureMoveset);
-    moves.emplace_after(lastMove, square, captureSquare, Move::Capture);
-    lastMove++;
-    captureMoveset &= captureMoveset - 1;
-  }
+  const uint64_t moveset = diagonalAttacks(occupancy, square) & legalTargetMask<color>(square);
 
-  return moves;
+  if constexpr (type != GenerateCaptures)
+    addMoves(moves, square, moveset & ~occupancy);
+  if constexpr (type != GenerateQuiets)
+    addMoves(moves, square, moveset & enemyBitboard, Move::Capture);
 }
 
 #pragma region rook moves
 
-const std::forward_list<Move> Board::getLegalRookMoves(Piece::Color color, uint8_t square) const {
-  std::forward_list<Move> moves;
-  std::forward_list<Move>::iterator lastMove{moves.before_begin()};
+template <Piece::Color color, Board::MoveGenType type>
+void Board::getLegalRookMoves(MoveList &moves, uint8_t square) const {
+  const uint64_t occupancyBitboard = bitboards.getAllPiecesBitboard();
+  const uint64_t enemyBitboard = bitboards.getPiecesBitboard<!color>();
 
-  const uint64_t *movesets = MagicBitboards::orthMovesets[square];
-  const uint64_t &occupancyMask = MagicBitboards::orthMasks[square];
-  const uint64_t &magic = MagicBitboards::orthMagics[square];
-  const uint8_t &shift = MagicBitboards::orthShifts[square];
+  const uint64_t moveset = orthogonalAttacks(occupancyBitboard, square) & legalTargetMask<color>(square);
 
+  if constexpr (type != GenerateCaptures)
+    addMoves(moves, square, moveset & ~occupancyBitboard);
+  if constexpr (type != GenerateQuiets)
+    addMoves(moves, square, moveset & enemyBitboard, Move::Capture);
+}
+
+#pragma region queen moves
+
+template <Piece::Color color, Board::MoveGenType type>
+void Board::getLegalQueenMoves(MoveList &moves, uint8_t square) const {
   const uint64_t occupancyBitboard = bitboards.getAllPiecesBitboard();
-  const uint64_t enemyBitboard =
-      color == Piece::White ? bitboards.getBlackPiecesBitboard() : bitboards.getWhitePiecesBitboard();
+  const uint64_t enemyBitboard = bitboards.getPiecesBitboard<!color>();
 
-  const uint64_t &moveset = movesets[((occupancyBitboard & occupancyMask) * magic) >> shift];
+  const uint64_t moveset = (orthogonalAttacks(occupancyBitboard, square) | diagonalAttacks(occupancyBitboard, square)) &
+                           legalTargetMask<color>(square);
 
-  uint64_t moveMoveset = moveset & ~occupancyBitboard;
-  while (moveMoveset) {
-    uint8_t moveSquare = std::countr_zero(moveMoveset);
-    moves.emplace_after(lastMove, square, moveSquare);
-    lastMove++;
-    moveMoveset &= moveMoveset - 1;
-  }
+  if constexpr (type != GenerateCaptures)
+    addMoves(moves, square, moveset & ~occupancyBitboard);
+  if constexpr (type != GenerateQuiets)
+    addMoves(moves, square, moveset & enemyBitboard, Move::Capture);
+}
 
-  uint64_t captureMoveset = moveset & enemyBitboard;
-  while (captureMoveset) {
-    uint8_t captureSquare = std::countr_zero(captureMoveset);
-    moves.emplace_after(lastMove, square, captureSquare, Move::Capture);
-    lastMove++;
-    captureMoveset &= captureMoveset - 1;
-  }
+#pragma region king moves
 
-  return moves;
+template <Piece::Color color, Board::MoveGenType type>
+void Board::getLegalKingMoves(MoveList &moves, uint8_t square) const {
+  const uint64_t blockers = bitboards.getAllPiecesBitboard();
+  const uint64_t captures = bitboards.getPiecesBitboard<!color>();
+  // the king can't hide behind itself from a slider, take it off the board before looking at attacks
+  const uint64_t attacked = attackedSquares<!color>(blockers ^ bitmaskForSquare(square));
+  const uint64_t possibleMoves = kingAttacks[square] & ~attacked;
+
+  if constexpr (type != GenerateCaptures)
+    addMoves(moves, square, possibleMoves & ~blockers);
+  if constexpr (type != GenerateQuiets)
+    addMoves(moves, square, possibleMoves & captures, Move::Capture);
+
+  // castling is a quiet move, and never allowed out of check
+  if (type == GenerateCaptures || getCheckState<color>().checkers)
+    return;
+
+  if (canCastleKingside<color>(blockers, attacked))
+    moves.emplace(square, squareOffset(square, 0, 2), Move::Flag::CastleKingside);
+  if (canCastleQueenside<color>(blockers, attacked))
+    moves.emplace(square, squareOffset(square, 0, -2), Move::Flag::CastleQueenside);
 }
 
-#pragma region queen moves
+template <Piece::Color color> bool Board::canCastleKingside(uint64_t blockers, uint64_t attacked) const {
+  const BoardUtils::State &currentState = getCurrentState();
+  // much more *elegant* castle logic
+  // 0x60 = 0b01100000 -> . . . . . X X .
+  // the king also passes through these squares, so they can't be attacked either
+  constexpr uint64_t kingsideCastleBlockers = color == Piece::White ? 0x60ull : 0x60ull << 56;
+  return (color == Piece::White ? currentState.canWhiteCastleKingside() : currentState.canBlackCastleKingside()) &&
+         (blockers & kingsideCastleBlockers) == 0 && (attacked & kingsideCastleBlockers) == 0;
+}
 
-const std::forward_list<Move> Board::getLegalQueenMoves(Piece::Color color, uint8_t square) const {
-  std::forward_list<Move> moves;
-  std::forward_list<Move>::iterator lastMove{moves.before_begin()};
+template <Piece::Color color> bool Board::canCastleQueenside(uint64_t blockers, uint64_t attacked) const {
+  const BoardUtils::State &currentState = getCurrentState();
+  // 0xE = 0b00001110 -> . X X X . . . .
+  // 0xC = 0b00001100 -> . . X X . . . . (king path, the b-file square may be attacked)
+  constexpr uint64_t queensideCastleBlockers = color == Piece::White ? 0xEull : 0xEull << 56;
+  constexpr uint64_t queensideCastlePath = color == Piece::White ? 0xCull : 0xCull << 56;
+  return (color == Piece::White ? currentState.canWhiteCastleQueenside() : currentState.canBlackCastleQueenside()) &&
+         (blockers & queensideCastleBlockers) == 0 && (attacked & queensideCastlePath) == 0;
+}
 
-  const uint64_t *orthMovesets = MagicBitboards::orthMovesets[square];
-  const uint64_t &orthOccupancyMask = MagicBitboards::orthMasks[square];
-  const uint64_t &orthMagic = MagicBitboards::orthMagics[square];
-  const uint8_t &orthShift = MagicBitboards::orthShifts[square];
+#pragma region quiet checks
 
-  const uint64_t *diagMovesets = MagicBitboards::diagMovesets[square];
-  const uint64_t &diagOccupancyMask = MagicBitboards::diagMasks[square];
-  const uint64_t &diagMagic = MagicBitboards::diagMagics[square];
-  const uint8_t &diagShift = MagicBitboards::diagShifts[square];
+template <Piece::Color color> void Board::generateQuietChecks(MoveList &moves) const {
+  const uint64_t occupancy = bitboards.getAllPiecesBitboard();
+  const uint64_t empty = ~occupancy;
+  const uint8_t kingSquare = std::countr_zero(bitboards.getBitboard(Piece::King, color));
+  const uint8_t enemyKingSquare = std::countr_zero(bitboards.getBitboard(Piece::King, !color));
+
+  // squares each piece type gives check from, looked up backwards from the enemy king
+  // a pawn of ours attacks the king from wherever an enemy pawn on the king's square would attack
+  const uint64_t pawnChecks = pawnAttacks[!color][enemyKingSquare];
+  const uint64_t knightChecks = knightAttacks[enemyKingSquare];
+  const uint64_t bishopChecks = diagonalAttacks(occupancy, enemyKingSquare);
+  const uint64_t rookChecks = orthogonalAttacks(occupancy, enemyKingSquare);
+  const uint64_t discoverers = getDiscoveredCheckCandidates<color>(occupancy, enemyKingSquare);
+
+  // any move off the line between the slider and the king uncovers the check
+  auto checkTargets = [&](uint8_t square, uint64_t directChecks) {
+    return discoverers & bitmaskForSquare(square) ? directChecks | ~squaresInLine[enemyKingSquare][square]
+                                                  : directChecks;
+  };
+
+  // king moves only ever check by discovery, and can't castle out of check
+  if (discoverers & bitmaskForSquare(kingSquare)) {
+    const uint64_t attacked = attackedSquares<!color>(occupancy ^ bitmaskForSquare(kingSquare));
+    addMoves(moves, kingSquare, kingAttacks[kingSquare] & empty & ~attacked & checkTargets(kingSquare, 0));
+  }
+  const CheckState &checkState = getCheckState<color>();
+  if (checkState.checkMask == 0)
+    return;
+
+  // pawns that can't discover share one target mask, the rest are done one at a time
+  // promotions are left to the capture generator, so the promotion rank is masked off
+  constexpr uint64_t promotionMask = bitmaskForRow(color == Piece::White ? 7 : 0);
+  const uint64_t pawns = bitboards.getBitboard(Piece::Pawn, color);
+  const uint64_t singlePawns = pawns & (discoverers | checkState.pinned);
+  generatePawnMoves<color, GenerateQuiets>(moves, pawns & ~singlePawns,
+                                           checkState.checkMask & pawnChecks & ~promotionMask);
+  for (uint64_t remaining{singlePawns}; remaining; remaining &= remaining - 1) {
+    const uint8_t square = std::countr_zero(remaining);
+    generatePawnMoves<color, GenerateQuiets>(
+        moves, bitmaskForSquare(square),
+        legalTargetMask<color>(square) & checkTargets(square, pawnChecks) & ~promotionMask);
+  }
 
-  const uint64_t occupancyBitboard = bitboards.getAllPiecesBitboard();
-  const uint64_t enemyBitboard =
-      color == Piece::White ? bitboards.getBlackPiecesBitboard() : bitboards.getWhitePiecesBitboard();
-
-  const uint64_t moveset = orthMovesets[((occupancyBitboard & orthOccupancyMask) * orthMagic) >> orthShift] |
-                           diagMovesets[((occupancyBitboard & diagOccupancyMask) * diagMagic) >> diagShift];
-
-  uint64_t moveMoveset = moveset & ~occupancyBitboard;
-  while (moveMoveset) {
-    uint8_t moveSquare = std::countr_zero(moveMoveset);
-    moves.emplace_after(lastMove, square, moveSquare);
-    lastMove++;
-    moveMoveset ^= 1ull << moveSquare;
+  for (const uint8_t square : pieceIndex.getSquares(Piece::Knight, color))
+    addMoves(moves, square,
+                  knightAttacks[square] & empty & legalTargetMask<color>(square) & checkTargets(square, knightChecks));
+  for (const uint8_t square : pieceIndex.getSquares(Piece::Bishop, color))
+    addMoves(moves, square,
+                  diagonalAttacks(occupancy, square) & empty & legalTargetMask<color>(square) &
+                      checkTargets(square, bishopChecks));
+  for (const uint8_t square : pieceIndex.getSquares(Piece::Rook, color))
+    addMoves(moves, square,
+                  orthogonalAttacks(occupancy, square) & empty & legalTargetMask<color>(square) &
+                      checkTargets(square, rookChecks));
+  for (const uint8_t square : pieceIndex.getSquares(Piece::Queen, color))
+    addMoves(moves, square,
+                  (diagonalAttacks(occupancy, square) | orthogonalAttacks(occupancy, square)) & empty &
+                      legalTargetMask<color>(square) & checkTargets(square, bishopChecks | rookChecks));
+}
+
+#pragma region move counting
+
+template <Piece::Color color> unsigned int Board::countPawnMoves(uint64_t pawns, uint64_t targetMask) const {
+  const uint64_t blockerBitboard = bitboards.getAllPiecesBitboard();
+  const uint64_t enemyBitboard = bitboards.getPiecesBitboard<!color>();
+
+  // same shifts as generatePawnMoves, just counted instead of unpacked
+  constexpr int forward = color == Piece::White ? 8 : -8;
+  constexpr int captureLeft = forward - 1;
+  constexpr int captureRight = forward + 1;
+  constexpr uint64_t promotionMask = bitmaskForRow(color == Piece::White ? 7 : 0);
+  constexpr uint64_t doublePushMask = bitmaskForRow(color == Piece::White ? 2 : 5);
+
+  const uint64_t singlePushes = shiftBitboard(pawns, forward) & ~blockerBitboard;
+  const uint64_t doublePushes = shiftBitboard(singlePushes & doublePushMask, forward) & ~blockerBitboard & targetMask;
+  const uint64_t leftCaptures = shiftBitboard(pawns & ~bitmaskForCol(0), captureLeft) & enemyBitboard & targetMask;
+  const uint64_t rightCaptures =
+      shiftBitboard(pawns & ~bitmaskForCol(7), captureRight) & enemyBitboard & targetMask;
+
+  // a pawn move landing on the last rank is four moves, one per promotion
+  const uint64_t single = (singlePushes & targetMask & ~promotionMask) | doublePushes;
+  const uint64_t promotions = (singlePushes & targetMask) & promotionMask;
+  unsigned int count = std::popcount(single) + std::popcount(leftCaptures & ~promotionMask) +
+                       std::popcount(rightCaptures & ~promotionMask) +
+                       4 * (std::popcount(promotions) + std::popcount(leftCaptures & promotionMask) +
+                            std::popcount(rightCaptures & promotionMask));
+
+  // en passant has to be played out, same as when generating
+  const BoardUtils::State &state = getCurrentState();
+  if (state.enPassantAvailable()) {
+    constexpr uint64_t enPassantRankMask = bitmaskForRow(color == Piece::White ? 5 : 2);
+    const uint64_t enPassantBit = enPassantRankMask & bitmaskForCol(state.getEnPassantFile());
+    const uint8_t enPassantSquare = std::countr_zero(enPassantBit);
+    if (shiftBitboard(pawns & ~bitmaskForCol(0), captureLeft) & enPassantBit)
+      count += enPassantIsLegal<color>(enPassantSquare - captureLeft, enPassantSquare);
+    if (shiftBitboard(pawns & ~bitmaskForCol(7), captureRight) & enPassantBit)
+      count += enPassantIsLegal<color>(enPassantSquare - captureRight, enPassantSquare);
   }
+  return count;
+}
 
-  uint64_t captureMoveset = moveset & enemyBitboard;
-  while (captureMoveset) {
-    uint8_t captureSquare = std::countr_zero(captureMoveset);
-    moves.emplace_after(lastMove, square, captureSquare, Move::Capture);
-    lastMove++;
-    captureMoveset ^= 1ull << captureSquare;
+template <Piece::Color color> unsigned int Board::countLegalMoves() const {
+  const uint64_t occupancy = bitboards.getAllPiecesBitboard();
+  const uint64_t available = ~bitboards.getPiecesBitboard<color>();
+  const uint8_t kingSquare = std::countr_zero(bitboards.getBitboard(Piece::King, color));
+
+  const uint64_t attacked = attackedSquares<!color>(occupancy ^ bitmaskForSquare(kingSquare));
+  unsigned int count = std::popcount(kingAttacks[kingSquare] & available & ~attacked);
+  const CheckState &checkState = getCheckState<color>();
+  if (checkState.checkMask == 0)
+    return count;
+  if (!checkState.checkers)
+    count += canCastleKingside<color>(occupancy, attacked) + canCastleQueenside<color>(occupancy, attacked);
+
+  const uint64_t pawns = bitboards.getBitboard(Piece::Pawn, color);
+  const uint64_t pinnedPawns = pawns & checkState.pinned;
+  count += countPawnMoves<color>(pawns & ~pinnedPawns, checkState.checkMask);
+  for (uint64_t pinned{pinnedPawns}; pinned; pinned &= pinned - 1) {
+    const uint8_t square = std::countr_zero(pinned);
+    count += countPawnMoves<color>(bitmaskForSquare(square), legalTargetMask<color>(square));
   }
 
-  return moves;
+  for (const uint8_t square : pieceIndex.getSquares(Piece::Knight, color))
+    count += std::popcount(knightAttacks[square] & available & legalTargetMask<color>(square));
+  for (const uint8_t square : pieceIndex.getSquares(Piece::Bishop, color))
+    count += std::popcount(diagonalAttacks(occupancy, square) & available & legalTargetMask<color>(square));
+  for (const uint8_t square : pieceIndex.getSquares(Piece::Rook, color))
+    count += std::popcount(orthogonalAttacks(occupancy, square) & available & legalTargetMask<color>(square));
+  for (const uint8_t square : pieceIndex.getSquares(Piece::Queen, color))
+    count += std::popcount((diagonalAttacks(occupancy, square) | orthogonalAttacks(occupancy, square)) &
+                           available & legalTargetMask<color>(square));
+  return count;
 }
 
-#pragma region king moves
+unsigned int Board::countLegalMoves() const {
+  return whiteMove() ? countLegalMoves<Piece::White>() : countLegalMoves<Piece::Black>();
+}
 
-const std::forward_list<Move> Board::getLegalKingMoves(Piece::Color color, uint8_t square) const {
-  const BoardUtils::State &currentState = getCurrentState();
-  std::forward_list<Move> moves;
-  std::forward_list<Move>::iterator lastMove{moves.before_begin()};
+#pragma region legal targets
 
-  const uint64_t blockers = bitboards.getAllPiecesBitboard();
-  const uint64_t captures =
-      color == Piece::White ? bitboards.getBlackPiecesBitboard() : bitboards.getWhitePiecesBitboard();
-  const uint64_t &possibleMoves = kingAttacks[square];
-
-  uint64_t movesBitboard = possibleMoves & ~blockers;
-  while (movesBitboard) {
-    uint8_t moveSquare = std::countr_zero(movesBitboard);
-    moves.emplace_after(lastMove, square, moveSquare);
-    lastMove++;
-    movesBitboard &= movesBitboard - 1;
+template <Piece::Color color, bool legal> uint64_t Board::pieceTargets(uint8_t square) const {
+  const uint64_t occupancy = bitboards.getAllPiecesBitboard();
+  const uint64_t available = ~bitboards.getPiecesBitboard<color>();
+  // pseudo legal targets ignore checks and pins
+  const uint64_t mask = legal ? legalTargetMask<color>(square) : ~0ull;
+
+  switch (getPiece(square).type()) {
+  case Piece::Pawn: {
+    constexpr int forward = color == Piece::White ? 8 : -8;
+    constexpr uint64_t doublePushMask = bitmaskForRow(color == Piece::White ? 2 : 5);
+    const uint64_t singlePush = shiftBitboard(bitmaskForSquare(square), forward) & ~occupancy;
+    const uint64_t doublePush = shiftBitboard(singlePush & doublePushMask, forward) & ~occupancy;
+    const uint64_t captures = pawnAttacks[color][square] & bitboards.getPiecesBitboard<!color>();
+    uint64_t targets = (singlePush | doublePush | captures) & mask;
+
+    // en passant isn't covered by the masks, so it gets played out on its own
+    const BoardUtils::State &state = getCurrentState();
+    if (state.enPassantAvailable()) {
+      const uint64_t enPassantBit =
+          bitmaskForRow(color == Piece::White ? 5 : 2) & bitmaskForCol(state.getEnPassantFile());
+      if ((pawnAttacks[color][square] & enPassantBit) &&
+          (!legal || enPassantIsLegal<color>(square, std::countr_zero(enPassantBit))))
+        targets |= enPassantBit;
+    }
+    return targets;
   }
-
-  uint64_t capturesBitboard = possibleMoves & captures;
-  while (capturesBitboard) {
-    uint8_t captureSquare = std::countr_zero(capturesBitboard);
-    moves.emplace_after(lastMove, square, captureSquare, Move::Capture);
-    lastMove++;
-    capturesBitboard &= capturesBitboard - 1;
+  case Piece::Knight:
+    return knightAttacks[square] & available & mask;
+  case Piece::Bishop:
+    return diagonalAttacks(occupancy, square) & available & mask;
+  case Piece::Rook:
+    return orthogonalAttacks(occupancy, square) & available & mask;
+  case Piece::Queen:
+    return (diagonalAttacks(occupancy, square) | orthogonalAttacks(occupancy, square)) & available & mask;
+  case Piece::King: {
+    // castling through or out of check is never even pseudo legal, so attacks are needed either way
+    const uint64_t attacked = attackedSquares<!color>(occupancy ^ bitmaskForSquare(square));
+    uint64_t targets = kingAttacks[square] & available & (legal ? ~attacked : ~0ull);
+    if (!getCheckState<color>().checkers) {
+      if (canCastleKingside<color>(occupancy, attacked))
+        targets |= bitmaskForSquare(squareOffset(square, 0, 2));
+      if (canCastleQueenside<color>(occupancy, attacked))
+        targets |= bitmaskForSquare(squareOffset(square, 0, -2));
+    }
+    return targets;
+  }
+  default:
+    return 0;
   }
+}
 
-  // much more *elegant* castle logic
-  // 0x60 = 0b01100000 -> . . . . . X X .
-  static const uint64_t kingsideCastleBlockers[2] = {0x60ull, 0x60ull << 56};
-  if (color == Piece::White ? currentState.canWhiteCastleKingside() : currentState.canBlackCastleKingside()) {
-    if ((blockers & kingsideCastleBlockers[color]) == 0) {
-      moves.emplace_after(lastMove, square, squareOffset(square, 0, 2), Move::Flag::CastleKingside);
-      lastMove++;
+uint64_t Board::getLegalTargets(unsigned char square) const {
+  const Piece &piece = getPiece(square);
+  // only the side to move has legal moves
+  if (piece == Piece::Empty || piece.color() != (whiteMove() ? Piece::White : Piece::Black))
+    return 0;
+
+  return whiteMove() ? pieceTargets<Piece::White, true>(square) : pieceTargets<Piece::Black, true>(square);
+}
+
+template <bool legal> bool Board::validateMove(const Move &move) const {
+  const uint8_t startSquare = move.startSquare();
+  const uint8_t endSquare = move.endSquare();
+  const Piece &piece = getPiece(startSquare);
+  if (piece == Piece::Empty || piece.color() != (whiteMove() ? Piece::White : Piece::Black))
+    return false;
+
+  const uint64_t targets = whiteMove() ? pieceTargets<Piece::White, legal>(startSquare)
+                                       : pieceTargets<Piece::Black, legal>(startSquare);
+  if (!(targets & bitmaskForSquare(endSquare)))
+    return false;
+  // the squares are right, the flags have to agree with what is actually on the board too
+  return move == resolveMove(startSquare, endSquare, move.promotionType());
+}
+
+bool Board::isPseudoLegal(const Move &move) const { return validateMove<false>(move); }
+bool Board::isLegal(const Move &move) const { return validateMove<true>(move); }
+
+Move Board::resolveMove(uint8_t startSquare, uint8_t endSquare, Piece::Type promotion) const {
+  const Piece &piece = getPiece(startSquare);
+  const bool capture = getPiece(endSquare) != Piece::Empty;
+
+  if (piece.isType(Piece::King) && (endSquare == startSquare + 2 || endSquare + 2 == startSquare))
+    return Move(startSquare, endSquare, endSquare > startSquare ? Move::CastleKingside : Move::CastleQueenside);
+
+  if (piece.isType(Piece::Pawn)) {
+    if (endSquare == startSquare + 16 || endSquare + 16 == startSquare)
+      return Move(startSquare, endSquare, Move::PawnDoubleMove);
+    // a pawn only changes file by capturing, if there's nothing there it must be en passant
+    if (!capture && squareCol(startSquare) != squareCol(endSquare))
+      return Move(startSquare, endSquare, Move::EnPassantCapture);
+    if (squareRow(endSquare) == 0 || squareRow(endSquare) == 7) {
+      Move::Flag flag;
+      switch (promotion) {
+      case Piece::Rook:
+        flag = capture ? Move::RookPromotionCapture : Move::RookPromotion;
+        break;
+      case Piece::Knight:
+        flag = capture ? Move::KnightPromotionCapture : Move::KnightPromotion;
+        break;
+      case Piece::Bishop:
+        flag = capture ? Move::BishopPromotionCapture : Move::BishopPromotion;
+        break;
+      default:
+        flag = capture ? Move::QueenPromotionCapture : Move::QueenPromotion;
+        break;
+      }
+      return Move(startSquare, endSquare, flag);
     }
   }
-  // 0xE = 0b00001110 -> . X X X . . . .
-  static const uint64_t queensideCastleBlockers[2] = {0xEull, 0xEull << 56};
-  if (color == Piece::White ? currentState.canWhiteCastleQueenside() : currentState.canBlackCastleQueenside()) {
-    if ((blockers & queensideCastleBlockers[color]) == 0) {
-      moves.emplace_after(lastMove, square, squareOffset(square, 0, -2), Move::Flag::CastleQueenside);
-    }
+
+  return Move(startSquare, endSquare, capture ? Move::Capture : Move::NoFlag);
+}
+
+#pragma region all moves
+
+template <Piece::Color color, Board::MoveGenType type> void Board::generateLegalMoves(MoveList &moves) const {
+  // evasions are just every legal move, but only exist while in check
+  const CheckState &checkState = getCheckState<color>();
+  if (type == GenerateEvasions && !checkState.checkers)
+    return;
+
+  const uint8_t kingSquare = pieceIndex.getSquares(Piece::King, color)[0];
+
+  // nothing but the king can get out of a double check
+  if (checkState.checkMask == 0) {
+    getLegalKingMoves<color, type>(moves, kingSquare);
+    return;
   }
 
+  generatePawnMoves<color, type>(moves, bitboards.getBitboard(Piece::Pawn, color));
+  for (const uint8_t square : pieceIndex.getSquares(Piece::Rook, color))
+    getLegalRookMoves<color, type>(moves, square);
+  for (const uint8_t square : pieceIndex.getSquares(Piece::Knight, color))
+    getLegalKnightMoves<color, type>(moves, square);
+  for (const uint8_t square : pieceIndex.getSquares(Piece::Bishop, color))
+    getLegalBishopMoves<color, type>(moves, square);
+  for (const uint8_t square : pieceIndex.getSquares(Piece::Queen, color))
+    getLegalQueenMoves<color, type>(moves, square);
+  getLegalKingMoves<color, type>(moves, kingSquare);
+}
+
+template <Piece::Color color> void Board::generateLegalMovesForSquare(MoveList &moves, uint8_t square) const {
+  switch (getPiece(square).type()) {
+  case Piece::Pawn:
+    getLegalPawnMoves<color, GenerateAll>(moves, square);
+    break;
+  case Piece::Rook:
+    getLegalRookMoves<color, GenerateAll>(moves, square);
+    break;
+  case Piece::Knight:
+    getLegalKnightMoves<color, GenerateAll>(moves, square);
+    break;
+  case Piece::Bishop:
+    getLegalBishopMoves<color, GenerateAll>(moves, square);
+    break;
+  case Piece::Queen:
+    getLegalQueenMoves<color, GenerateAll>(moves, square);
+    break;
+  case Piece::King:
+    getLegalKingMoves<color, GenerateAll>(moves, square);
+    break;
+  default:
+    break;
+  }
+}
+
+template <Piece::Color color> void Board::generateLegalMoves(MoveList &moves, MoveGenType type) const {
+  switch (type) {
+  case GenerateAll:
+    generateLegalMoves<color, GenerateAll>(moves);
+    break;
+  case GenerateCaptures:
+    generateLegalMoves<color, GenerateCaptures>(moves);
+    break;
+  case GenerateQuiets:
+    generateLegalMoves<color, GenerateQuiets>(moves);
+    break;
+  case GenerateEvasions:
+    generateLegalMoves<color, GenerateEvasions>(moves);
+    break;
+  case GenerateQuietChecks:
+    generateQuietChecks<color>(moves);
+    break;
+  }
+}
+
+MoveList Board::getLegalMoves(MoveGenType type) const {
+  MoveList legalMoves;
+  getLegalMoves(legalMoves, type);
+  return legalMoves;
+}
+
+void Board::getLegalMoves(MoveList &moves, MoveGenType type) const {
+  if (whiteMove())
+    generateLegalMoves<Piece::White>(moves, type);
+  else
+    generateLegalMoves<Piece::Black>(moves, type);
+}
+
+MoveList Board::getLegalMovesForSquare(unsigned char square) const {
+  MoveList moves;
+  const Piece &piece = getPiece(square);
+  // only the side to move has legal moves
+  if (piece == Piece::Empty || piece.color() != (whiteMove() ? Piece::White : Piece::Black))
+    return moves;
+
+  if (whiteMove())
+    generateLegalMovesForSquare<Piece::White>(moves, square);
+  else
+    generateLegalMovesForSquare<Piece::Black>(moves, square);
   return moves;
 }
 } // namespace Chess
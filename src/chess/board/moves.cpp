@@ -1,29 +1,50 @@
+#include <algorithm>
 #include <cstdint>
+#include <stdexcept>
 
 #include "chess/board.hpp"
 #include "chess/board/state.hpp"
 #include "chess/move.hpp"
 #include "chess/piece.hpp"
+#include "chess/zobrist.hpp"
 
 namespace Chess {
 
 using BoardUtils::StateHistory;
 
-static const uint8_t kingsideRookStart[2] = {7, 63};
-static const uint8_t kingsideRookEnd[2] = {5, 61};
-static const uint8_t queensideRookStart[2] = {0, 56};
-static const uint8_t queensideRookEnd[2] = {3, 59};
+static constexpr uint8_t kingsideRookStart[2] = {7, 63};
+static constexpr uint8_t kingsideRookEnd[2] = {5, 61};
+static constexpr uint8_t queensideRookStart[2] = {0, 56};
+static constexpr uint8_t queensideRookEnd[2] = {3, 59};
 
 #pragma region perform
 void Board::makeMove(const Move &move) {
+  if (whiteMove())
+    makeMove<Piece::White>(move);
+  else
+    makeMove<Piece::Black>(move);
+}
+
+bool Board::makeMove(uint8_t startSquare, uint8_t endSquare, Piece::Type promotion) {
+  if (startSquare >= 64 || endSquare >= 64)
+    return false;
+
+  const Move move = resolveMove(startSquare, endSquare, promotion);
+  if (!isLegal(move))
+    return false;
+  makeMove(move);
+  return true;
+}
+
+template <Piece::Color color> void Board::makeMove(const Move &move) {
   Piece piece(getPiece(move.startSquare()));
 
   // we trust that the move we were given is legal. please.
+  // state goes first every time, so the pieces moving are hashed into the new state
 
   if (move.flags() == Move::Flag::PawnDoubleMove) {
+    state.pushDoublePawnPushState(move, piece);
     movePiece(piece, move.startSquare(), move.endSquare());
-    state.pushDoublePawnPushState(move);
-    refreshEphermalState();
     return;
   }
 
@@ -31,44 +52,39 @@ void Board::makeMove(const Move &move) {
   if (move.flags() == Move::Flag::CastleKingside) {
     const uint8_t kingStart = move.startSquare();
     const uint8_t kingEnd = move.endSquare();
-    const Piece::Color color = piece.color();
 
+    state.pushCastleState(move, piece);
     movePiece(piece, kingStart, kingEnd);
     movePiece(getPiece(kingsideRookStart[color]), kingsideRookStart[color], kingsideRookEnd[color]);
-    state.pushCastleState(move);
-    refreshEphermalState();
     return;
   }
   if (move.flags() == Move::Flag::CastleQueenside) {
     const uint8_t kingStart = move.startSquare();
     const uint8_t kingEnd = move.endSquare();
-    const Piece::Color color = piece.color();
 
+    state.pushCastleState(move, piece);
     movePiece(piece, kingStart, kingEnd);
     movePiece(getPiece(queensideRookStart[color]), queensideRookStart[color], queensideRookEnd[color]);
-    state.pushCastleState(move);
-    refreshEphermalState();
     return;
   }
 
   // standard moves beyond this point
   // handle captures
   Piece capturedPiece{Piece::Empty};
+  uint8_t captureSquare{move.endSquare()};
   switch (move.flags()) {
   case Move::Flag::RookPromotionCapture:
   case Move::Flag::KnightPromotionCapture:
   case Move::Flag::BishopPromotionCapture:
   case Move::Flag::QueenPromotionCapture:
   case Move::Flag::Capture:
-    capturedPiece = getPiece(move.endSquare());
-    removePiece(capturedPiece, move.endSquare());
+    capturedPiece = getPiece(captureSquare);
     break;
 
   // en passant is special. my special little boy.
   case Move::Flag::EnPassantCapture: {
-    uint8_t captureSquare = squareOffset(move.endSquare(), whiteMove() ? -1 : 1, 0);
+    captureSquare = squareOffset(move.endSquare(), color == Piece::White ? -1 : 1, 0);
     capturedPiece = getPiece(captureSquare);
-    removePiece(capturedPiece, captureSquare);
     break;
   }
 
@@ -105,9 +121,9 @@ void Board::makeMove(const Move &move) {
 
   // castling change
   StateHistory::CastlingChange castlingChange{StateHistory::CastlingChange::None};
-  if (move.startSquare() == square(whiteMove() ? 0 : 7, 0) && piece.isType(Piece::Rook)) {
+  if (move.startSquare() == queensideRookStart[color] && piece.isType(Piece::Rook)) {
     castlingChange = StateHistory::CastlingChange::QueensideRookMove;
-  } else if (move.startSquare() == square(whiteMove() ? 0 : 7, 7) && piece.isType(Piece::Rook)) {
+  } else if (move.startSquare() == kingsideRookStart[color] && piece.isType(Piece::Rook)) {
     castlingChange = StateHistory::CastlingChange::KingsideRookMove;
   } else if (piece.isType(Piece::King)) {
     castlingChange = StateHistory::CastlingChange::KingMove;
@@ -115,89 +131,158 @@ void Board::makeMove(const Move &move) {
 
   // update state
   if (capturedPiece != Piece::Empty) // no capture
-    state.pushCaptureState(move, capturedPiece, castlingChange);
+    state.pushCaptureState(move, piece, capturedPiece, captureSquare, castlingChange);
   else // yes capture
     state.pushState(move, piece, castlingChange);
 
   // update board
+  if (capturedPiece != Piece::Empty)
+    removePiece(capturedPiece, captureSquare);
   if (promotionType != 0)
     moveAndTransformPiece(piece, move.startSquare(), move.endSquare(), promotionType);
   else
     movePiece(piece, move.startSquare(), move.endSquare());
 
-  refreshEphermalState();
   return;
 }
+template void Board::makeMove<Piece::White>(const Move &move);
+template void Board::makeMove<Piece::Black>(const Move &move);
 
 #pragma region undo
 void Board::unmakeMove() {
-  const BoardUtils::State &undoState = state.popSnapshot();
-  const Move &move = undoState.getPreviousMove();
-  const Piece movedPiece(getPiece(move.endSquare()));
+  if (!state.hasPreviousMove())
+    throw std::runtime_error("unmaking a move beyond initial state");
+  // a null move moved nothing, there is nothing for unmakeMove<color> to put back
+  if (state.getCurrentState().isNullMove())
+    throw std::runtime_error("unmaking a null move with unmakeMove, use unmakeNullMove");
+
+  // the side that made the last move is the one not to move now
+  if (whiteMove())
+    unmakeMove<Piece::Black>();
+  else
+    unmakeMove<Piece::White>();
 
-  if (move.flags() == Move::Flag::CastleKingside) {
-    const uint8_t kingStart = move.startSquare();
-    const uint8_t kingEnd = move.endSquare();
-    const Piece::Color color = movedPiece.color();
+  // pieces were put back while the move's state was still on top, so dropping it restores the hash as well
+  state.popSnapshot();
+}
 
-    movePiece(movedPiece, kingEnd, kingStart);
-    movePiece(getPiece(kingsideRookEnd[color]), kingsideRookEnd[color], kingsideRookStart[color]);
-    refreshEphermalState();
-    return;
-  }
-  if (move.flags() == Move::Flag::CastleQueenside) {
-    const uint8_t kingStart = move.startSquare();
-    const uint8_t kingEnd = move.endSquare();
-    const Piece::Color color = movedPiece.color();
+template <Piece::Color color> void Board::unmakeMove() {
+  // everything needed is recorded in the state, nothing has to be worked out from the move flags
+  const BoardUtils::State &undoState = state.getCurrentState();
+  const Move &move = undoState.getPreviousMove();
+  const Piece &movedPiece = undoState.getMovedPiece();
 
-    movePiece(movedPiece, kingEnd, kingStart);
-    movePiece(getPiece(queensideRookEnd[color]), queensideRookEnd[color], queensideRookStart[color]);
-    refreshEphermalState();
-    return;
-  }
+  // put the moved piece back as it was, which also takes back a promotion
+  const Piece endPiece{getPiece(move.endSquare())};
+  if (endPiece == movedPiece)
+    movePiece(movedPiece, move.endSquare(), move.startSquare());
+  else
+    moveAndTransformPiece(endPiece, move.endSquare(), move.startSquare(), movedPiece.type());
+
+  if (undoState.getLastCapture() != Piece::Empty)
+    summonPiece(undoState.getLastCapture(), undoState.getCaptureSquare());
+  else if (move.flags() == Move::Flag::CastleKingside)
+    movePiece(Piece(color, Piece::Rook), kingsideRookEnd[color], kingsideRookStart[color]);
+  else if (move.flags() == Move::Flag::CastleQueenside)
+    movePiece(Piece(color, Piece::Rook), queensideRookEnd[color], queensideRookStart[color]);
+}
+template void Board::unmakeMove<Piece::White>();
+template void Board::unmakeMove<Piece::Black>();
+
+#pragma region hashing
+uint64_t Board::computeHash() const {
+  const BoardUtils::State &currentState = getCurrentState();
+  uint64_t hash{0};
+  for (uint8_t square{0}; square < 64; square++)
+    if (board[square] != Piece::Empty)
+      hash ^= Zobrist::pieceKey(board[square], square);
+  hash ^= Zobrist::keys.castling[currentState.state & 0x0F];
+  if (currentState.enPassantAvailable())
+    hash ^= Zobrist::keys.enPassant[currentState.getEnPassantFile()];
+  if (blackMove())
+    hash ^= Zobrist::keys.blackToMove;
+  return hash;
+}
 
-  // back to standard moves
+#pragma region null move
+void Board::makeNullMove() {
+  if (isInCheck())
+    throw std::runtime_error("null move while in check");
+  state.pushNullState();
+}
 
-  // handle de-promotions
-  switch (move.flags()) {
-  case Move::Flag::RookPromotion:
-  case Move::Flag::RookPromotionCapture:
-  case Move::Flag::KnightPromotion:
-  case Move::Flag::KnightPromotionCapture:
-  case Move::Flag::BishopPromotion:
-  case Move::Flag::BishopPromotionCapture:
-  case Move::Flag::QueenPromotion:
-  case Move::Flag::QueenPromotionCapture:
-    board[move.startSquare()] = Piece(movedPiece, Piece::Pawn);
-    break;
+void Board::unmakeNullMove() {
+  if (!state.getCurrentState().isNullMove())
+    throw std::runtime_error("unmaking a null move that was not made");
+  state.popSnapshot();
+}
 
-  default:
-    // no promotion, just put the moved piece back
-    movePiece(movedPiece, move.endSquare(), move.startSquare());
-    break;
+#pragma region draws
+bool Board::isDraw(int ply) const {
+  const BoardUtils::State &currentState = getCurrentState();
+  const int fiftyMoveCounter = currentState.getFiftyMoveCounter();
+  // checkmate on the hundredth halfmove still wins
+  if (fiftyMoveCounter >= 100 && (!isInCheck() || countLegalMoves() != 0))
+    return true;
+  if (hasInsufficientMaterial())
+    return true;
+
+  // nothing before the last pawn move, capture or null move can come back, and the side to move has
+  // to match, so only every other position since then can repeat this one
+  const int end = std::min<int>({fiftyMoveCounter, currentState.getPliesSinceNullMove(), state.movesMade()});
+  bool seenBefore{false};
+  for (int i{4}; i <= end; i += 2) {
+    if (state.getStateMovesAgo(i).getHash() != currentState.getHash())
+      continue;
+    if (i <= ply || seenBefore)
+      return true;
+    seenBefore = true;
   }
+  return false;
+}
 
-  // restore capture
-  const Piece &lastCapture = undoState.getLastCapture();
-  switch (move.flags()) {
-  case Move::Flag::RookPromotionCapture:
-  case Move::Flag::KnightPromotionCapture:
-  case Move::Flag::BishopPromotionCapture:
-  case Move::Flag::QueenPromotionCapture:
-  case Move::Flag::Capture:
-    summonPiece(lastCapture, move.endSquare());
-    break;
-
-  case Move::Flag::EnPassantCapture: {
-    const uint8_t captureSquare = squareOffset(move.endSquare(), whiteMove() ? -1 : 1, 0);
-    summonPiece(lastCapture, captureSquare);
-    break;
+bool Board::hasInsufficientMaterial() const {
+  static constexpr uint64_t kings = materialKey(Piece::King, Piece::White) + materialKey(Piece::King, Piece::Black);
+  static constexpr uint64_t bishops =
+      materialKey(Piece::Bishop, Piece::White) + materialKey(Piece::Bishop, Piece::Black);
+  static constexpr uint64_t lightSquares = 0x55AA55AA55AA55AAull;
+
+  switch (pieceIndex.getMaterialKey() - kings) {
+  // bare kings, or a single minor piece
+  case 0:
+  case materialKey(Piece::Knight, Piece::White):
+  case materialKey(Piece::Knight, Piece::Black):
+  case materialKey(Piece::Bishop, Piece::White):
+  case materialKey(Piece::Bishop, Piece::Black):
+    return true;
+  // a bishop each, only a draw when both run on the same color
+  case bishops: {
+    const uint64_t bishopSquares = bitboards.getPieceTypeBitboard(Piece::Bishop);
+    return (bishopSquares & lightSquares) == 0 || (bishopSquares & ~lightSquares) == 0;
   }
-
   default:
-    break;
+    return false;
   }
-  refreshEphermalState();
-  return;
+}
+
+#pragma region copy-make
+Position Board::getPosition() const {
+  const BoardUtils::State &currentState = getCurrentState();
+  Position position{};
+  for (int i{0}; i < 6; i++)
+    position.pieces[i] = bitboards.getPieceTypeBitboard(static_cast<Piece::Type>(Piece::Pawn + i * 2));
+  position.colorOccupancy[Piece::White] = bitboards.getWhitePiecesBitboard();
+  position.colorOccupancy[Piece::Black] = bitboards.getBlackPiecesBitboard();
+  position.occupancy = bitboards.getAllPiecesBitboard();
+  position.hash = getHash();
+  position.sideToMove = whiteMove() ? Piece::White : Piece::Black;
+  position.castling = currentState.state & 0x0F;
+  // en passant target sits behind the pawn that double pushed
+  const Move &previousMove = currentState.getPreviousMove();
+  position.enPassantSquare = currentState.enPassantAvailable()
+                                 ? (previousMove.startSquare() + previousMove.endSquare()) / 2
+                                 : Position::noSquare;
+  position.fiftyMoveCounter = currentState.getFiftyMoveCounter();
+  return position;
 }
 } // namespace Chess
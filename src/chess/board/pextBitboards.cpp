@@ -0,0 +1,64 @@
+#include "chess/board/pextBitboards.hpp"
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <immintrin.h>
+
+namespace Chess::PextBitboards {
+// every square's slice, back to back. sizes are the sums of 2^(mask bits) over all squares
+static uint64_t orthMovesets[102400];
+static uint64_t diagMovesets[5248];
+
+static constexpr int orthDirections[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+static constexpr int diagDirections[4][2] = {{1, 1}, {-1, -1}, {1, -1}, {-1, 1}};
+
+/// @brief walk the rays from a square, stopping on (and including) the first blocker
+static uint64_t slide(const int (&directions)[4][2], uint8_t square, uint64_t occupancy) {
+  uint64_t attacks{0};
+  for (const auto &direction : directions) {
+    int row = square / 8 + direction[0];
+    int col = square % 8 + direction[1];
+    for (; row >= 0 && row < 8 && col >= 0 && col < 8; row += direction[0], col += direction[1]) {
+      const uint64_t bit = 1ull << (row * 8 + col);
+      attacks |= bit;
+      if (occupancy & bit)
+        break;
+    }
+  }
+  return attacks;
+}
+
+/// @brief squares a slider's attacks depend on - the rays without the last square of each
+static uint64_t relevantOccupancy(const int (&directions)[4][2], uint8_t square) {
+  uint64_t mask{0};
+  for (const auto &direction : directions) {
+    int row = square / 8 + direction[0];
+    int col = square % 8 + direction[1];
+    for (; row + direction[0] >= 0 && row + direction[0] < 8 && col + direction[1] >= 0 && col + direction[1] < 8;
+         row += direction[0], col += direction[1])
+      mask |= 1ull << (row * 8 + col);
+  }
+  return mask;
+}
+
+static std::array<Entry, 64> buildTables(const int (&directions)[4][2], uint64_t *movesets) {
+  std::array<Entry, 64> entries{};
+  for (uint8_t square{0}; square < 64; square++) {
+    const uint64_t mask = relevantOccupancy(directions, square);
+    entries[square] = {mask, movesets};
+
+    // visit every subset of the mask, pext puts each one at its own index
+    uint64_t occupancy{0};
+    do {
+      movesets[_pext_u64(occupancy, mask)] = slide(directions, square, occupancy);
+      occupancy = (occupancy - mask) & mask;
+    } while (occupancy);
+    movesets += uint64_t{1} << std::popcount(mask);
+  }
+  return entries;
+}
+
+const std::array<Entry, 64> orth = buildTables(orthDirections, orthMovesets);
+const std::array<Entry, 64> diag = buildTables(diagDirections, diagMovesets);
+} // namespace Chess::PextBitboards
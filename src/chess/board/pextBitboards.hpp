@@ -0,0 +1,32 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <immintrin.h>
+
+/*
+  slider lookups for x86-64 cpus with BMI2, picked in cmake with SLIDER_BACKEND.
+
+  pext packs the occupancy bits under a square's mask into a dense index, so unlike
+  magics there are no collisions and no constants to search for - every square gets
+  exactly 2^(bits in mask) entries, and the tables are built when the program starts.
+*/
+
+namespace Chess::PextBitboards {
+/// @brief lookup data for a single square
+struct Entry {
+  /// @brief squares whose occupancy can block the slider, board edges excluded
+  uint64_t mask;
+  /// @brief attacks for every occupancy of the mask, indexed by pext
+  const uint64_t *movesets;
+};
+
+extern const std::array<Entry, 64> orth;
+extern const std::array<Entry, 64> diag;
+
+inline uint64_t orthogonalAttacks(uint64_t occupancy, uint8_t square) {
+  return orth[square].movesets[_pext_u64(occupancy, orth[square].mask)];
+}
+inline uint64_t diagonalAttacks(uint64_t occupancy, uint8_t square) {
+  return diag[square].movesets[_pext_u64(occupancy, diag[square].mask)];
+}
+} // namespace Chess::PextBitboards
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+
+#if defined(PEXT_BITBOARDS)
+#include "chess/board/pextBitboards.hpp"
+#elif defined(LINE_ATTACKS)
+#include "chess/board/lineAttacks.hpp"
+#else
+#include "chess/board/magicBitboards.hpp"
+#endif
+
+/*
+  every slider lookup goes through these two, the backend is chosen in cmake (SLIDER_BACKEND).
+  shared by Board and Position so neither has to know which one it is
+*/
+
+namespace Chess::Sliders {
+inline uint64_t diagonalAttacks(uint64_t occupancy, uint8_t square) {
+#if defined(PEXT_BITBOARDS)
+  return PextBitboards::diagonalAttacks(occupancy, square);
+#elif defined(LINE_ATTACKS)
+  return LineAttacks::diagonalAttacks(occupancy, square);
+#else
+  return MagicBitboards::diagonalAttacks(occupancy, square);
+#endif
+}
+inline uint64_t orthogonalAttacks(uint64_t occupancy, uint8_t square) {
+#if defined(PEXT_BITBOARDS)
+  return PextBitboards::orthogonalAttacks(occupancy, square);
+#elif defined(LINE_ATTACKS)
+  return LineAttacks::orthogonalAttacks(occupancy, square);
+#else
+  return MagicBitboards::orthogonalAttacks(occupancy, square);
+#endif
+}
+} // namespace Chess::Sliders
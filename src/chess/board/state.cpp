@@ -8,34 +8,36 @@ namespace Chess {
 
 #pragma region state change
 void BoardUtils::StateHistory::pushState(const Move &move, Piece movedPiece, CastlingChange castlingChange) {
-  State newState(history[current++], move, movedPiece.isType(Piece::Pawn));
+  State newState(getCurrentState(), move, movedPiece, movedPiece.isType(Piece::Pawn));
 
   switch (castlingChange) {
   case CastlingChange::KingMove:
     newState.state &= currentTurnIsWhite() ? ~State::whiteCastleMask : ~State::blackCastleMask;
     break;
   case CastlingChange::KingsideRookMove:
-    newState.state &= currentTurnIsWhite() ? ~State::whiteCastleKingsideMask : State::blackCastleKingsideMask;
+    newState.state &= currentTurnIsWhite() ? ~State::whiteCastleKingsideMask : ~State::blackCastleKingsideMask;
     break;
   case CastlingChange::QueensideRookMove:
-    newState.state &= currentTurnIsWhite() ? ~State::whiteCastleQueensideMask : State::blackCastleQueensideMask;
+    newState.state &= currentTurnIsWhite() ? ~State::whiteCastleQueensideMask : ~State::blackCastleQueensideMask;
     break;
   default:
     break;
   }
 
-  history[current] = newState;
+  push(newState);
 }
 
-void BoardUtils::StateHistory::pushCaptureState(const Move &move, Piece capturedPiece, CastlingChange castlingChange) {
-  State newState(history[current], move, capturedPiece);
+void BoardUtils::StateHistory::pushCaptureState(const Move &move, Piece movedPiece, Piece capturedPiece,
+                                                uint8_t captureSquare, CastlingChange castlingChange) {
+  State newState(getCurrentState(), move, movedPiece, capturedPiece, captureSquare);
 
-  // castling changes
-  if (capturedPiece.isType(Piece::Rook) && Board::squareCol(move.endSquare()) == 0) {
+  // castling changes, only a rook still on its starting square can castle
+  const uint8_t enemyBackRow = currentTurnIsWhite() ? 7 : 0;
+  if (capturedPiece.isType(Piece::Rook) && move.endSquare() == Board::square(enemyBackRow, 7)) {
     // kingside rook capture
     newState.state &= currentTurnIsWhite() ? ~State::blackCastleKingsideMask : ~State::whiteCastleKingsideMask;
   }
-  if (capturedPiece.isType(Piece::Rook) && Board::squareCol(move.endSquare()) == 7) {
+  if (capturedPiece.isType(Piece::Rook) && move.endSquare() == Board::square(enemyBackRow, 0)) {
     // queenside rook capture
     newState.state &= currentTurnIsWhite() ? ~State::blackCastleQueensideMask : ~State::whiteCastleQueensideMask;
   }
@@ -54,21 +56,29 @@ void BoardUtils::StateHistory::pushCaptureState(const Move &move, Piece captured
     break;
   }
 
-  history[++current] = newState;
+  push(newState);
 }
 
-void BoardUtils::StateHistory::pushCastleState(const Move &move) {
-  State newState(history[current], move);
+void BoardUtils::StateHistory::pushCastleState(const Move &move, Piece movedPiece) {
+  State newState(getCurrentState(), move, movedPiece);
   // disable castling after this move
   newState.state &= ~(currentTurnIsWhite() ? State::whiteCastleMask : State::blackCastleMask);
-  history[++current] = newState;
+  push(newState);
+}
+
+void BoardUtils::StateHistory::pushNullState() {
+  // nothing moved, so castling carries over and en passant (taken from the move) goes away
+  State newState(getCurrentState(), Move::Empty, Piece::Empty);
+  newState.pliesSinceNullMove = 0;
+  newState.nullMove = 1;
+  push(newState);
 }
 
-void BoardUtils::StateHistory::pushDoublePawnPushState(const Move &move) {
-  State newState(history[current], move, true);
+void BoardUtils::StateHistory::pushDoublePawnPushState(const Move &move, Piece movedPiece) {
+  State newState(getCurrentState(), move, movedPiece, true);
   // mark en passant as available and add the file to state
   newState.state |=
       State::enPassantAvailabilityMask | (Board::squareCol(move.endSquare()) << State::enPassantFileShift);
-  history[++current] = newState;
+  push(newState);
 }
 } // namespace Chess
@@ -3,31 +3,61 @@
 #include <cstdint>
 #include <iterator>
 #include <stdexcept>
+#include <utility>
 #include <vector>
 
 #include "chess/move.hpp"
 #include "chess/piece.hpp"
+#include "chess/zobrist.hpp"
 
 namespace Chess {
+class Board; // forward declaration
 namespace BoardUtils {
 class StateHistory; // forward declaration
 /// @brief container for a single snapshot of board state
 class State {
   friend StateHistory;
+  friend Chess::Board;
+  // last made move (uint16)
+  Move move{Move::Empty};
   // `0x01` - white kingside castle available
   // `0x02` - black kingside castle available
   // `0x04` - white queenside castle available
   // `0x08` - black queenside castle available
   uint8_t state{0x0F};
-  // last made move (uint16)
-  Move move{Move::Empty};
   // fifty move counter
   uint8_t fiftyMoveCounter{0};
   // last capture (uint8)
   Chess::Piece lastCapture{Piece::Empty};
-
-  // u8 + u16 + u8 + u8 = 5 bytes
-  // probably the smallest i can make this
+  // square the last capture was made on, differs from the move's end square for en passant (uint8)
+  uint8_t captureSquare{0};
+  // piece that made the last move, as it was before any promotion, empty for a null move (uint8)
+  Chess::Piece movedPiece{Piece::Empty};
+  // halfmoves since the last null move or the start of the history, saturating (7 bits)
+  // positions on the other side of a null move can't count as repetitions
+  uint8_t pliesSinceNullMove : 7 {0};
+  // set only by a null move - an empty move and piece alone also describe the initial state (1 bit)
+  uint8_t nullMove : 1 {0};
+  // zobrist hash of the position (uint64)
+  // the state on top of the history holds the live hash - the board xors piece keys into it as pieces
+  // move, so unmaking a move gets the old hash back just by dropping the state
+  uint64_t hash{0};
+  // castling rights, en passant and hash from before the last move aren't repeated here, they are
+  // exactly what the state below holds
+
+  /// @brief check and pin state of the side to move
+  /// worked out by the board the first time a position needs it, and thrown away with the rest of
+  /// the state on unmake - so going back up the tree never recomputes it
+  struct CheckState {
+    // enemy pieces giving check
+    uint64_t checkers;
+    // our pieces pinned to our king
+    uint64_t pinned;
+    // squares a piece other than the king may move to, every square when not in check
+    uint64_t checkMask;
+    bool computed{false};
+  };
+  mutable CheckState checkState{};
 
   State() = default;
 
@@ -35,20 +65,27 @@ class State {
   /// only need to deal with castling legality changes
   /// @param other previous state to copy from
   /// @param moveMade move that this state will represent
+  /// @param moved piece that made the move
   /// @param resetFiftyMove reset the fifty move counter instead of increment
-  State(const State &previous, const Move &moveMade, bool resetFiftyMove = false) {
+  State(const State &previous, const Move &moveMade, Piece moved, bool resetFiftyMove = false) {
     // copy state
     state = previous.state & 0x0F; // only keep castling state, not en passant
     if (!resetFiftyMove)
       fiftyMoveCounter = previous.fiftyMoveCounter + 1;
+    pliesSinceNullMove = previous.pliesSinceNullMove + (previous.pliesSinceNullMove != maxPliesSinceNullMove);
     move = moveMade;
+    movedPiece = moved;
   }
   /// @brief copy constructor for captures
   /// @param previous previous state to copy from
   /// @param moveMade previous move made at this state
+  /// @param moved piece that made the move
   /// @param capture captured piece
-  State(const State &previous, const Move &moveMade, Piece &capture) : State(previous, moveMade, true) {
+  /// @param square square the captured piece was on
+  State(const State &previous, const Move &moveMade, Piece moved, Piece capture, uint8_t square)
+      : State(previous, moveMade, moved, true) {
     lastCapture = capture;
+    captureSquare = square;
   }
 
   static const uint8_t whiteCastleKingsideMask = 0x01;
@@ -59,6 +96,8 @@ class State {
   static const unsigned int enPassantFileShift = 5;
   static const uint8_t enPassantFileMask = 0xE0;
 
+  static const uint8_t maxPliesSinceNullMove = 0x7F;
+
   static const uint8_t whiteCastleMask = 0x05;
   static const uint8_t blackCastleMask = 0x0A;
 
@@ -71,23 +110,112 @@ public:
   bool enPassantAvailable() const { return move.flags() == Move::PawnDoubleMove; }
   uint8_t getEnPassantFile() const { return move.startSquare() & 0b111; }
   uint8_t getFiftyMoveCounter() const { return fiftyMoveCounter; }
+  uint8_t getPliesSinceNullMove() const { return pliesSinceNullMove; }
+  bool isNullMove() const { return nullMove; }
 
   const Piece &getLastCapture() const { return lastCapture; }
+  uint8_t getCaptureSquare() const { return captureSquare; }
+  const Piece &getMovedPiece() const { return movedPiece; }
   const Move &getPreviousMove() const { return move; }
+  uint64_t getHash() const { return hash; }
 };
 
+static_assert(sizeof(State) <= 48, "states are pushed every move, keep them within 48 bytes");
+
 /// @brief container of all board history
-class StateHistory {
+/// moves of the game are kept in growable storage, moves made during a search go on a separate
+/// stack indexed by ply, allocated once by beginSearch, so searching never allocates and never runs
+/// into the game's length. both live on the heap - what the board holds is one cache line of counters
+/// and a pointer to the state on top, which is all finding the current state needs
+class alignas(64) StateHistory {
+public:
+  /// @brief deepest a search can go below the position it started from
+  static constexpr size_t maxSearchPly{128};
+
+private:
+  // state on top of the history, whichever of the two stacks it is in
+  State *top;
   // importing games from FEN/PGN - starting halfmove (fullmove - 1 * 2) + black turn?
   unsigned short startHalfmove{0};
-  // turn is decided by halfmove
+  // game and search plies together, every move (null moves included) passes the turn
   unsigned short current{0};
-  // history of state (long games around 150 moves long)
-  static const size_t initialHistorySize{300};
-  size_t historySize{initialHistorySize};
-  State history[initialHistorySize];
+  unsigned short searchPly{0};
+  bool searching{false};
+  // history of the game, [0, current - searchPly] is in use. never shrinks, so popped states stay valid
+  std::vector<State> history{State()};
+  // states pushed since the search started, [0, searchPly) is in use. maxSearchPly long while searching,
+  // except in a copy made mid-search, which only has the plies in use until its next push
+  std::vector<State> searchStack;
+
+  /// @brief get the state a number of halfmoves into the stored history
+  /// @param index halfmoves since the initial state
+  inline const State &getState(int index) const {
+    const int gameLength = current - searchPly;
+    return index <= gameLength ? history[index] : searchStack[index - gameLength - 1];
+  }
+
+  /// @brief put a new state on top of the history, carrying the hash over from the state below
+  /// castling rights, en passant file and side to move are hashed here, pieces are left to the board
+  inline void push(State &newState) {
+    const State &previous = getCurrentState();
+    newState.hash = previous.hash ^ Zobrist::keys.blackToMove ^ Zobrist::keys.castling[previous.state & 0x0F] ^
+                    Zobrist::keys.castling[newState.state & 0x0F];
+    if (previous.enPassantAvailable())
+      newState.hash ^= Zobrist::keys.enPassant[previous.getEnPassantFile()];
+    if (newState.enPassantAvailable())
+      newState.hash ^= Zobrist::keys.enPassant[newState.getEnPassantFile()];
+
+    if (searching) {
+      if (searchPly >= searchStack.size()) {
+        if (searchPly >= maxSearchPly)
+          throw std::runtime_error("search went deeper than the search stack");
+        searchStack.resize(maxSearchPly, State());
+      }
+      top = &searchStack[searchPly++];
+    } else {
+      if (current + 1u >= history.size())
+        history.push_back(newState);
+      top = &history[current + 1];
+    }
+    *top = newState;
+    current++;
+  }
 
 public:
+  StateHistory() { top = &history[0]; }
+  // the search stack is only copied as far as it is in use, and filled back out on the copy's next push
+  StateHistory(const StateHistory &other)
+      : startHalfmove(other.startHalfmove), current(other.current), searchPly(other.searchPly),
+        searching(other.searching), history(other.history),
+        searchStack(other.searchStack.begin(), other.searchStack.begin() + other.searchPly) {
+    top = searchPly ? &searchStack[searchPly - 1] : &history[current];
+  }
+  StateHistory &operator=(const StateHistory &other) {
+    if (this != &other)
+      *this = StateHistory(other);
+    return *this;
+  }
+  // the moved-from history is left as a fresh one, holding only the initial state
+  StateHistory(StateHistory &&other) : StateHistory() { swap(other); }
+  StateHistory &operator=(StateHistory &&other) {
+    if (this != &other) {
+      StateHistory moved{std::move(other)};
+      swap(moved);
+    }
+    return *this;
+  }
+
+  /// @brief exchange two histories, swapped vectors keep their storage so both top pointers stay valid
+  void swap(StateHistory &other) noexcept {
+    std::swap(top, other.top);
+    std::swap(startHalfmove, other.startHalfmove);
+    std::swap(current, other.current);
+    std::swap(searchPly, other.searchPly);
+    std::swap(searching, other.searching);
+    history.swap(other.history);
+    searchStack.swap(other.searchStack);
+  }
+
   struct Iterator {
     using iterator_category = std::forward_iterator_tag;
     using difference_type = std::ptrdiff_t;
@@ -117,30 +245,55 @@ public:
     pointer m_ptr;
   };
 
-  Iterator begin() const { return Iterator(&history[1]); }
-  Iterator end() const { return Iterator(&history[current + 1]); }
+  /// @brief iterate the moves of the game, not including any search in progress
+  Iterator begin() const { return Iterator(history.data() + 1); }
+  Iterator end() const { return Iterator(history.data() + (current - searchPly) + 1); }
 
   inline unsigned short currentHalfmove() const { return current + startHalfmove; }
   inline unsigned short currentFullmove() const { return (current + startHalfmove) / 2 + 1; }
 
-  inline bool currentTurnIsWhite() const { return current % 2 == 0; }
-  inline bool currentTurnIsBlack() const { return current % 2 == 1; }
+  inline bool currentTurnIsWhite() const { return (current + startHalfmove) % 2 == 0; }
+  inline bool currentTurnIsBlack() const { return (current + startHalfmove) % 2 == 1; }
+
+  inline const State &getInitialState() const { return history[0]; }
+
+  inline const State &getStateAtHalfmove(int halfmove) const { return getState(halfmove - startHalfmove); }
 
-  inline const State &getStateAtHalfmove(int halfmove) const { return history[halfmove - startHalfmove]; }
+  inline const State &getStateMovesAgo(int halfmovesAgo) const { return getState(current - halfmovesAgo); }
 
-  inline const State &getStateMovesAgo(int halfmovesAgo) const { return history[current - halfmovesAgo]; }
+  inline const State &getCurrentState() const { return *top; }
 
-  inline const State &getCurrentState() const { return history[current]; }
+  inline bool hasPreviousMove() const { return current > 0; }
+  /// @brief number of moves stored, game and search together
+  inline unsigned short movesMade() const { return current; }
+
+  /// @brief xor a key into the hash of the current position
+  inline void toggleHash(uint64_t key) { top->hash ^= key; }
 
   inline const std::vector<Move> getMoveHistory() const {
     std::vector<Move> moves;
     if (current >= 1)
       for (int i{1}; i <= current; i++) {
-        moves.push_back(history[i].move);
+        moves.push_back(getState(i).move);
       }
     return moves;
   }
 
+  /// @brief start keeping states on the search stack instead of the game history
+  /// the search stack is allocated the first time, and kept for later searches
+  void beginSearch() {
+    if (searching)
+      throw std::runtime_error("search already in progress");
+    searchStack.resize(maxSearchPly, State());
+    searching = true;
+  }
+  /// @brief go back to keeping states in the game history, every search move must be unmade first
+  void endSearch() {
+    if (searchPly != 0)
+      throw std::runtime_error("ending search with moves still made");
+    searching = false;
+  }
+
   // state change operations
   // all Board functions that return StateHistory (which should be *none*)
   // can't call these non-const functions. thanks c++.
@@ -160,10 +313,21 @@ public:
     if (!canBlackCastleQueenside)
       initialState.state ^= State::blackCastleQueensideMask;
 
-    if (enPassantAvailable)
+    if (enPassantAvailable) {
       initialState.state |= State::enPassantAvailabilityMask | (enPassantFile << State::enPassantFileShift);
+      // en passant is read off the previous move, so make up the double push that allowed it
+      const bool whitePushed = halfmove % 2 == 1;
+      initialState.move = Move(whitePushed ? 8 + enPassantFile : 48 + enPassantFile,
+                               whitePushed ? 24 + enPassantFile : 32 + enPassantFile, Move::PawnDoubleMove);
+      initialState.hash ^= Zobrist::keys.enPassant[enPassantFile];
+    }
 
     initialState.fiftyMoveCounter = fiftyMoveCounter;
+
+    // pieces have already been hashed as they were placed
+    initialState.hash ^= Zobrist::keys.castling[initialState.state & 0x0F];
+    if (halfmove % 2 == 1)
+      initialState.hash ^= Zobrist::keys.blackToMove;
   }
 
   enum CastlingChange {
@@ -181,26 +345,38 @@ public:
 
   /// @brief push state showing capture
   /// @param move move that has been made
+  /// @param movedPiece piece that has been moved
   /// @param capturedPiece piece that was just captured
+  /// @param captureSquare square the captured piece was on
   /// @param castlingChange piece movement that cancels castling rights
-  void pushCaptureState(const Move &move, Chess::Piece capturedPiece, CastlingChange castlingChange = None);
+  void pushCaptureState(const Move &move, Chess::Piece movedPiece, Chess::Piece capturedPiece, uint8_t captureSquare,
+                        CastlingChange castlingChange = None);
 
   /// @brief push state showing a double pawn push
-  void pushDoublePawnPushState(const Move &move);
+  /// @param move double pawn push performed
+  /// @param movedPiece pawn that has been moved
+  void pushDoublePawnPushState(const Move &move, Chess::Piece movedPiece);
+
+  /// @brief push state for a null move, passing the turn
+  void pushNullState();
 
   /// @brief push state representing a castle
   /// @param move castle move performed
-  void pushCastleState(const Move &move);
+  /// @param movedPiece king that has castled
+  void pushCastleState(const Move &move, Chess::Piece movedPiece);
 
-  /// @brief 'unmake' previous move in state
+  /// @brief 'unmake' previous move in state, the hash goes back to that of the state below
   /// @return state reference for the move that is being unmade
   /// \attention Do not use returned state after pushing new state.
   const State &popSnapshot() {
     if (current <= 0)
       throw std::runtime_error("popping state beyond initial state");
-    State &prevState = history[current];
+    const State *popped = top;
     current--;
-    return prevState;
+    if (searchPly)
+      searchPly--;
+    top = searchPly ? &searchStack[searchPly - 1] : &history[current];
+    return *popped;
   }
 };
 } // namespace BoardUtils
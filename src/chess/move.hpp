@@ -46,6 +46,13 @@ struct Move {
     return static_cast<Flag>((move >> 12) & 0x0F); // Extract the last 4 bits
   };
 
+  bool isPromotion() const { return flags() >= RookPromotion; }
+  /// @brief get the piece type a promotion promotes to, meaningless for other moves
+  Piece::Type promotionType() const {
+    // both promotion runs are ordered rook, knight, bishop, queen - same as the piece types
+    return static_cast<Piece::Type>(Piece::Rook + ((flags() - RookPromotion) & 0x3) * 2);
+  }
+
   Move(uint8_t start, uint8_t end, Flag flags = NoFlag) {
     move = (flags << 12) | (end << 6) | start; // Combine into a single 16-bit number
   }
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstddef>
+#include <stdexcept>
+
+#include "chess/move.hpp"
+
+namespace Chess {
+/// @brief fixed capacity, contiguous list of moves that lives on the stack
+/// no legal position has more than 218 moves, so generating never allocates
+struct MoveList {
+  static constexpr size_t capacity{256};
+
+  MoveList() {}
+
+  /// @brief construct a move in place at the end of the list
+  /// @param start start square of the move
+  /// @param end end square of the move
+  /// @param flags flags of the move
+  inline void emplace(uint8_t start, uint8_t end, Move::Flag flags = Move::NoFlag) {
+#ifdef DEBUG
+    if (count >= capacity)
+      throw std::runtime_error("move list overflow");
+#endif
+    moves[count++] = Move(start, end, flags);
+  }
+  inline void push(const Move &move) {
+#ifdef DEBUG
+    if (count >= capacity)
+      throw std::runtime_error("move list overflow");
+#endif
+    moves[count++] = move;
+  }
+  inline void clear() { count = 0; }
+
+  inline size_t size() const { return count; }
+  inline bool empty() const { return count == 0; }
+
+  inline Move &operator[](size_t index) { return moves[index]; }
+  inline const Move &operator[](size_t index) const { return moves[index]; }
+  inline const Move &front() const { return moves[0]; }
+
+  inline Move *begin() { return moves; }
+  inline Move *end() { return moves + count; }
+  inline const Move *begin() const { return moves; }
+  inline const Move *end() const { return moves + count; }
+
+private:
+  size_t count{0};
+  // left uninitialized on purpose, only [0, count) is ever read
+  union {
+    Move moves[capacity];
+  };
+};
+} // namespace Chess
@@ -0,0 +1,138 @@
+#include "chess/movePicker.hpp"
+
+#include <cstdint>
+#include <utility>
+
+#include "chess/board.hpp"
+#include "chess/move.hpp"
+#include "chess/piece.hpp"
+
+namespace Chess {
+// indexed by piece type / 2, the king is never captured and never loses material by capturing
+static constexpr int16_t pieceValues[7]{0, 100, 500, 300, 300, 900, 0};
+
+static inline int16_t pieceValue(Piece::Type type) { return pieceValues[type >> 1]; }
+
+Move MovePicker::next() {
+  switch (stage) {
+  case HashMove:
+    stage = GenerateCaptures;
+    if (hashMove != Move::Empty && board.isLegal(hashMove))
+      return hashMove;
+    [[fallthrough]];
+
+  case GenerateCaptures:
+    board.getLegalMoves(moves, Board::GenerateCaptures);
+    for (size_t i{0}; i < moves.size(); i++)
+      scores[i] = captureScore(moves[i]);
+    stage = WinningCaptures;
+    [[fallthrough]];
+
+  case WinningCaptures:
+    while (current < moves.size()) {
+      // selection sort one move at a time, a cutoff usually comes before the list is sorted
+      size_t best{current};
+      for (size_t i{current + 1}; i < moves.size(); i++)
+        if (scores[i] > scores[best])
+          best = i;
+      std::swap(moves[current], moves[best]);
+      std::swap(scores[current], scores[best]);
+
+      const Move move{moves[current++]};
+      if (move == hashMove)
+        continue;
+      if (isLosingCapture(move)) {
+        losingCaptures.push(move);
+        continue;
+      }
+      return move;
+    }
+    stage = Killers;
+    [[fallthrough]];
+
+  case Killers:
+    while (killerIndex < killers.size()) {
+      const Move &killer{killers[killerIndex++]};
+      if (killer == Move::Empty || killer == hashMove)
+        continue;
+      if (killerIndex == 2 && killer == killers[0])
+        continue;
+      if (isQuiet(killer) && board.isLegal(killer))
+        return killer;
+    }
+    stage = GenerateQuiets;
+    [[fallthrough]];
+
+  case GenerateQuiets:
+    moves.clear();
+    board.getLegalMoves(moves, Board::GenerateQuiets);
+    current = 0;
+    stage = Quiets;
+    [[fallthrough]];
+
+  case Quiets:
+    while (current < moves.size()) {
+      const Move move{moves[current++]};
+      if (move == hashMove || move == killers[0] || move == killers[1])
+        continue;
+      return move;
+    }
+    stage = LosingCaptures;
+    [[fallthrough]];
+
+  case LosingCaptures:
+    if (losingCurrent < losingCaptures.size())
+      return losingCaptures[losingCurrent++];
+    stage = Done;
+    [[fallthrough]];
+
+  case Done:
+  default:
+    return Move::Empty;
+  }
+}
+
+bool MovePicker::isQuiet(const Move &move) {
+  switch (move.flags()) {
+  case Move::NoFlag:
+  case Move::PawnDoubleMove:
+  case Move::CastleKingside:
+  case Move::CastleQueenside:
+    return true;
+  default:
+    return false;
+  }
+}
+
+bool MovePicker::isLosingCapture(const Move &move) const {
+  const Move::Flag flags{move.flags()};
+  // promotions and en passant never lose material
+  if (flags != Move::Capture)
+    return false;
+
+  const Piece attacker{board.getPiece(move.startSquare())};
+  const Piece victim{board.getPiece(move.endSquare())};
+  if (pieceValue(victim.type()) >= pieceValue(attacker.type()))
+    return false;
+
+  // taking a cheaper piece only loses if the enemy can take back
+  const uint64_t occupancy{board.bitboards.getAllPiecesBitboard() & ~Board::bitmaskForSquare(move.startSquare())};
+  return board.squareAttacked(occupancy, move.endSquare(), attacker.color());
+}
+
+int16_t MovePicker::captureScore(const Move &move) const {
+  const Move::Flag flags{move.flags()};
+  const Piece attacker{board.getPiece(move.startSquare())};
+
+  int16_t score{0};
+  if (flags == Move::EnPassantCapture)
+    score = pieceValue(Piece::Pawn);
+  else if (flags == Move::Capture || flags >= Move::RookPromotionCapture)
+    score = pieceValue(board.getPiece(move.endSquare()).type());
+  if (move.isPromotion())
+    score += pieceValue(move.promotionType()) - pieceValue(Piece::Pawn);
+
+  // between captures of equal value, try the cheapest attacker first
+  return score - (attacker.type() >> 1);
+}
+} // namespace Chess
@@ -0,0 +1,65 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+#include "chess/board.hpp"
+#include "chess/move.hpp"
+#include "chess/moveList.hpp"
+
+namespace Chess {
+/// @brief hands out the legal moves of a position one at a time, best guesses first
+/// moves are produced in stages, and each stage is only generated once the previous one runs dry,
+/// so a search that cuts off early never pays for generating the quiet moves
+/// @note the board must not change while the picker is in use
+class MovePicker {
+public:
+  enum Stage : uint8_t {
+    HashMove,
+    GenerateCaptures,
+    WinningCaptures,
+    Killers,
+    GenerateQuiets,
+    Quiets,
+    LosingCaptures,
+    Done,
+  };
+
+  /// @brief create a move picker for the side to move
+  /// @param board board to pick moves from
+  /// @param hashMove best move from a previous search of this position, or Move::Empty
+  /// @param killers quiet moves that caused a cutoff at the same ply elsewhere, or Move::Empty
+  MovePicker(const Board &board, Move hashMove = Move::Empty, std::array<Move, 2> killers = {Move::Empty, Move::Empty})
+      : board(board), hashMove(hashMove), killers(killers) {}
+
+  /// @brief get the next move to search
+  /// @return the next legal move, or Move::Empty once every move has been handed out
+  Move next();
+
+  Stage getStage() const { return stage; }
+
+private:
+  const Board &board;
+  const Move hashMove;
+  const std::array<Move, 2> killers;
+
+  Stage stage{HashMove};
+  uint8_t killerIndex{0};
+
+  /// @brief moves of the stage currently being handed out
+  MoveList moves;
+  /// @brief ordering scores for captures, parallel to moves
+  int16_t scores[MoveList::capacity];
+  size_t current{0};
+
+  /// @brief captures that lose material, held back until after the quiets
+  MoveList losingCaptures;
+  size_t losingCurrent{0};
+
+  /// @brief whether a move could have come from the quiet generator
+  static bool isQuiet(const Move &move);
+  /// @brief guess whether a capture gives away more than it takes
+  bool isLosingCapture(const Move &move) const;
+  /// @brief most valuable victim, least valuable attacker
+  int16_t captureScore(const Move &move) const;
+};
+} // namespace Chess
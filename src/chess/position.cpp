@@ -0,0 +1,95 @@
+#include "chess/position.hpp"
+
+#include <array>
+#include <cstdint>
+
+#include "chess/move.hpp"
+#include "chess/piece.hpp"
+#include "chess/zobrist.hpp"
+
+namespace Chess {
+/// @brief castling rights still available after a piece moves from or to each square
+static constexpr std::array<uint8_t, 64> castlingRightsMask = []() constexpr {
+  std::array<uint8_t, 64> masks{};
+  masks.fill(0x0F);
+  masks[0] &= ~Position::whiteCastleQueensideMask;
+  masks[7] &= ~Position::whiteCastleKingsideMask;
+  masks[4] &= ~(Position::whiteCastleKingsideMask | Position::whiteCastleQueensideMask);
+  masks[56] &= ~Position::blackCastleQueensideMask;
+  masks[63] &= ~Position::blackCastleKingsideMask;
+  masks[60] &= ~(Position::blackCastleKingsideMask | Position::blackCastleQueensideMask);
+  return masks;
+}();
+
+Piece Position::getPiece(uint8_t square) const {
+  const uint64_t bit = 1ull << square;
+  if (!(occupancy & bit))
+    return Piece::Empty;
+  const Piece::Color color = colorOccupancy[Piece::White] & bit ? Piece::White : Piece::Black;
+  for (int i{0}; i < 6; i++)
+    if (pieces[i] & bit)
+      return Piece(color, static_cast<Piece::Type>(Piece::Pawn + i * 2));
+  return Piece::Empty;
+}
+
+#pragma region making moves
+void Position::makeMove(const Move &move) {
+  const Piece::Color us = sideToMove;
+  const uint8_t start = move.startSquare();
+  const uint8_t end = move.endSquare();
+  const Piece::Type type = getPiece(start).type();
+
+  if (enPassantSquare != noSquare)
+    hash ^= Zobrist::keys.enPassant[enPassantSquare & 0b111];
+  enPassantSquare = noSquare;
+  fiftyMoveCounter++;
+
+  switch (move.flags()) {
+  case Move::Capture:
+  case Move::RookPromotionCapture:
+  case Move::KnightPromotionCapture:
+  case Move::BishopPromotionCapture:
+  case Move::QueenPromotionCapture:
+    toggle(getPiece(end).type(), !us, end);
+    fiftyMoveCounter = 0;
+    break;
+  case Move::EnPassantCapture:
+    toggle(Piece::Pawn, !us, us == Piece::White ? end - 8 : end + 8);
+    break;
+  case Move::PawnDoubleMove:
+    enPassantSquare = (start + end) / 2;
+    hash ^= Zobrist::keys.enPassant[enPassantSquare & 0b111];
+    break;
+  case Move::CastleKingside:
+    toggle(Piece::Rook, us, start + 3);
+    toggle(Piece::Rook, us, start + 1);
+    break;
+  case Move::CastleQueenside:
+    toggle(Piece::Rook, us, start - 4);
+    toggle(Piece::Rook, us, start - 1);
+    break;
+  default:
+    break;
+  }
+
+  toggle(type, us, start);
+  toggle(move.isPromotion() ? move.promotionType() : type, us, end);
+  if (type == Piece::Pawn)
+    fiftyMoveCounter = 0;
+
+  hash ^= Zobrist::keys.castling[castling];
+  castling &= castlingRightsMask[start] & castlingRightsMask[end];
+  hash ^= Zobrist::keys.castling[castling] ^ Zobrist::keys.blackToMove;
+  sideToMove = !us;
+}
+
+bool Position::operator==(const Position &other) const {
+  for (int i{0}; i < 6; i++)
+    if (pieces[i] != other.pieces[i])
+      return false;
+  return colorOccupancy[0] == other.colorOccupancy[0] && colorOccupancy[1] == other.colorOccupancy[1] &&
+         occupancy == other.occupancy &&
+         hash == other.hash && sideToMove == other.sideToMove && castling == other.castling &&
+         enPassantSquare == other.enPassantSquare && fiftyMoveCounter == other.fiftyMoveCounter;
+}
+} // namespace Chess
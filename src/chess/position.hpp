@@ -0,0 +1,73 @@
+#pragma once
+#include <cstdint>
+#include <type_traits>
+
+#include "chess/move.hpp"
+#include "chess/piece.hpp"
+#include "chess/zobrist.hpp"
+
+namespace Chess {
+/// @brief compact, trivially copyable snapshot of a position for copy-make search
+/// a child position is a copy of its parent with one move applied, so unmaking a move is just
+/// dropping the copy. holds no mailbox, piece lists or history - only what the bitboards need.
+/// it doesn't generate moves of its own, moves come from Board's legal move generation
+struct Position {
+  static constexpr uint8_t noSquare{64};
+
+  // `0x01` - white kingside castle available
+  // `0x02` - black kingside castle available
+  // `0x04` - white queenside castle available
+  // `0x08` - black queenside castle available
+  // (same layout as BoardUtils::State)
+  static constexpr uint8_t whiteCastleKingsideMask{0x01};
+  static constexpr uint8_t blackCastleKingsideMask{0x02};
+  static constexpr uint8_t whiteCastleQueensideMask{0x04};
+  static constexpr uint8_t blackCastleQueensideMask{0x08};
+
+  /// @brief one bitboard per piece type with both colors in it, indexed by typeIndex()
+  uint64_t pieces[6];
+  /// @brief occupancy of each color
+  uint64_t colorOccupancy[2];
+  /// @brief every piece on the board
+  uint64_t occupancy;
+  /// @brief zobrist hash, the same as Board::getHash() for the same position
+  uint64_t hash;
+
+  Piece::Color sideToMove;
+  uint8_t castling;
+  /// @brief square a pawn can capture en passant onto, or noSquare
+  uint8_t enPassantSquare;
+  uint8_t fiftyMoveCounter;
+
+  static constexpr int typeIndex(Piece::Type type) { return (type - Piece::Pawn) >> 1; }
+
+  inline uint64_t getBitboard(Piece::Type type, Piece::Color color) const {
+    return pieces[typeIndex(type)] & colorOccupancy[color];
+  }
+  inline uint64_t getAllPiecesBitboard() const { return occupancy; }
+
+  /// @brief find the piece on a square by looking through the bitboards
+  /// @param square square to look at
+  /// @return the piece on that square, or Piece::Empty
+  Piece getPiece(uint8_t square) const;
+
+  /// @brief apply a move to this position
+  /// @param move legal move for this position, as generated by a Board in the same position
+  void makeMove(const Move &move);
+
+  bool operator==(const Position &other) const;
+
+private:
+  /// @brief add or remove a piece on a square, keeping the occupancy and hash up to date
+  inline void toggle(Piece::Type type, Piece::Color color, uint8_t square) {
+    const uint64_t bit = 1ull << square;
+    pieces[typeIndex(type)] ^= bit;
+    colorOccupancy[color] ^= bit;
+    occupancy ^= bit;
+    hash ^= Zobrist::keys.pieces[type - Piece::Pawn + color][square];
+  }
+};
+
+static_assert(std::is_trivially_copyable_v<Position>, "positions are copied around with memcpy");
+static_assert(sizeof(Position) <= 128, "positions should stay within two cache lines");
+} // namespace Chess
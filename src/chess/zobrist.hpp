@@ -0,0 +1,58 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+#include "chess/piece.hpp"
+
+namespace Chess {
+/// @brief random keys for zobrist hashing, generated at compile time
+/// a position's hash is the xor of the keys of everything in it, so making a move only has to xor
+/// out what changed and xor in what replaced it
+namespace Zobrist {
+/// @brief splitmix64, small enough to run in a constexpr and good enough for hash keys
+constexpr uint64_t nextKey(uint64_t &seed) {
+  uint64_t z = (seed += 0x9E3779B97F4A7C15ull);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+struct Keys {
+  /// @brief one key per piece per square, indexed like Board::pieceToIndex
+  uint64_t pieces[12][64];
+  /// @brief one key per combination of castling rights, laid out like BoardUtils::State
+  /// each entry is the xor of the keys of the rights it holds, so no rights hashes to 0
+  uint64_t castling[16];
+  /// @brief one key per file a pawn can be captured en passant on
+  uint64_t enPassant[8];
+  /// @brief xored in when black is to move
+  uint64_t blackToMove;
+};
+
+inline constexpr Keys keys = []() constexpr {
+  Keys keys{};
+  uint64_t seed{0x3D5C4E55ull};
+  for (auto &piece : keys.pieces)
+    for (uint64_t &key : piece)
+      key = nextKey(seed);
+
+  uint64_t castlingRights[4];
+  for (uint64_t &key : castlingRights)
+    key = nextKey(seed);
+  for (int rights{0}; rights < 16; rights++)
+    for (int i{0}; i < 4; i++)
+      if (rights & (1 << i))
+        keys.castling[rights] ^= castlingRights[i];
+
+  for (uint64_t &key : keys.enPassant)
+    key = nextKey(seed);
+  keys.blackToMove = nextKey(seed);
+  return keys;
+}();
+
+/// @brief key for a piece standing on a square
+inline constexpr uint64_t pieceKey(const Piece &piece, uint8_t square) {
+  return keys.pieces[piece.piece - Piece::Pawn][square];
+}
+} // namespace Zobrist
+} // namespace Chess
@@ -1,6 +1,8 @@
 #include "game.hpp"
 
+#include <bit>
 #include <cmath>
+#include <cstdint>
 
 #include <3ds/os.h>
 #include <3ds/services/hid.h>
@@ -31,10 +33,7 @@ void Game::setSelectedSquare(unsigned char square) {
   selectedSquare = square;
 
   // get legal move spaces for selected square
-  legalMovesForSelectedSquare.clear();
-  for (auto move : board.getLegalMovesForSquare(square)) {
-    legalMovesForSelectedSquare.push_back(move);
-  }
+  legalTargetsForSelectedSquare = square < 64 ? board.getLegalTargets(square) : 0;
 }
 
 void Game::handleInput(u32 kDown, u32 kHeld, u32 kUp, touchPosition &touchPos) {
@@ -47,12 +46,9 @@ void Game::handleInput(u32 kDown, u32 kHeld, u32 kUp, touchPosition &touchPos) {
       unsigned char col = (touchX - 40) / 30;
       unsigned char row = 7 - touchY / 30;
 
-      // TODO - handle move with legalMovesForSelectedSquare
-      for (auto move : legalMovesForSelectedSquare) {
-        if (move.endSquare() == row * 8 + col) {
-          makeMove(move);
-          return;
-        }
+      if (legalTargetsForSelectedSquare & Chess::Board::bitmaskForSquare(row * 8 + col)) {
+        makeMove(selectedSquare, row * 8 + col);
+        return;
       }
 
       Chess::Piece piece = board.getPiece(row, col);
@@ -103,7 +99,7 @@ void Game::render() {
   u32 squareColor{0};
   Chess::Piece piece{};
   C2D_Image pieceImage;
-  Chess::Move lastMove = board.getLastMove();
+  Chess::Move lastMove = board.getCurrentState().getPreviousMove();
   bool previousMove = lastMove != Chess::Move::Empty;
   for (int i{0}; i < 64; i++) {
     // draw board
@@ -134,9 +130,10 @@ void Game::render() {
   }
 
   // draw legal moves
-  for (auto move : legalMovesForSelectedSquare) {
-    row = 7 - floor(move.endSquare() / 8);
-    col = move.endSquare() % 8;
+  for (uint64_t targets{legalTargetsForSelectedSquare}; targets; targets &= targets - 1) {
+    const int target = std::countr_zero(targets);
+    row = 7 - target / 8;
+    col = target % 8;
     C2D_DrawCircleSolid(col * 30 + 40 + 15, row * 30 + 15, 0, 5, Color::LegalMove);
   }
 
@@ -1,6 +1,6 @@
 #pragma once
 
-#include <vector>
+#include <cstdint>
 
 #include <3ds.h>
 #include <3ds/services/hid.h>
@@ -23,7 +23,7 @@ protected:
   // selected piece
 
   unsigned char selectedSquare{noSelection};
-  std::vector<Chess::Move> legalMovesForSelectedSquare;
+  uint64_t legalTargetsForSelectedSquare{0};
   bool dragging{false};
   struct DragPosition {
     u16 dx;
@@ -38,21 +38,17 @@ public:
 
   bool makeMove(unsigned char fromSquare, unsigned char toSquare) {
     selectedSquare = noSelection; // reset selected square
-    legalMovesForSelectedSquare.clear();
+    legalTargetsForSelectedSquare = 0;
     return board.makeMove(fromSquare, toSquare);
   }
-  bool makeMove(const Chess::Move &move) {
-    selectedSquare = noSelection; // reset selected square
-    legalMovesForSelectedSquare.clear();
-    return board.makeMove(move.startSquare(), move.endSquare());
-  };
+  bool makeMove(const Chess::Move &move) { return makeMove(move.startSquare(), move.endSquare()); };
 
   static const unsigned char noSelection = 65;
   unsigned char getSelectedSquare() const { return selectedSquare; }
   void setSelectedSquare(unsigned char square);
   void setSelectedSquare(int row, int col) { setSelectedSquare(col + row * 8); }
 
-  const std::vector<Chess::Move> &getLegalMovesForSelectedSquare() const { return legalMovesForSelectedSquare; }
+  uint64_t getLegalTargetsForSelectedSquare() const { return legalTargetsForSelectedSquare; }
 
   void handleInput(u32 kDown, u32 kHeld, u32 kUp, touchPosition &touchPos);
   void render();
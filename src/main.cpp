@@ -1,4 +1,6 @@
+#include <cstdio>
 #include <cstdlib>
+#include <stdexcept>
 
 #include <3ds.h>
 #include <3ds/console.h>
@@ -17,6 +19,7 @@
 #include <c2d/spritesheet.h>
 #include <citro2d.h>
 
+#include "chess/board.hpp"
 #include "colors.hpp"
 #include "common.hpp"
 #include "game.hpp"
@@ -46,6 +49,27 @@ int main(int argc, char **argv) {
 
   C2D_Prepare();
 
+  try {
+    Chess::Board::loadSliderTables("romfs:/");
+  } catch (const std::runtime_error &error) {
+    // leave the error on the top screen until it has been read
+    std::printf("%s\n\nPress START to exit.\n", error.what());
+    while (aptMainLoop()) {
+      hidScanInput();
+      if (hidKeysDown() & KEY_START)
+        break;
+      gfxFlushBuffers();
+      gfxSwapBuffers();
+      gspWaitForVBlank();
+    }
+    C2D_Fini();
+    C3D_Fini();
+    gfxExit();
+    hidExit();
+    romfsExit();
+    return EXIT_FAILURE;
+  }
+
   pieces = C2D_SpriteSheetLoad("romfs:/pieces.t3x");
   C2D_AlphaImageTint(&transparentPieceTint, 0.6f);
 
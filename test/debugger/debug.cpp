@@ -30,16 +30,17 @@ void DebugEngine::draw() {
     ImGui::EndMenu();
   }
   if (ImGui::MenuItem("Undo Move")) {
-    if (game->board.getHalfmove() > 0)
+    if (game->board.hasPreviousMove())
       game->unmakeMove();
   }
   ImGui::EndMenuBar();
 
   ImGui::Text("In Check: %s", game->board.isInCheck() ? "yes" : "no");
+  ImGui::Text("Draw: %s", game->board.isDraw() ? "yes" : "no");
 
   if (ImGui::CollapsingHeader("State History")) {
     if (ImGui::TreeNode("Initial Position")) {
-      auto state = game->board.getStateHistory().getStateAtHalfmove(0);
+      auto state = game->board.getStateHistory().getInitialState();
       ImGui::Text("White can castle kingside: %s", state.canWhiteCastleKingside() ? "yes" : "no");
       ImGui::Text("White can castle queenside: %s", state.canWhiteCastleQueenside() ? "yes" : "no");
       ImGui::Text("Black can castle kingside: %s", state.canBlackCastleKingside() ? "yes" : "no");
@@ -312,6 +313,30 @@ void DebugEngine::draw() {
     }
   }
 
+  if (ImGui::CollapsingHeader("Benchmarks")) {
+    static int makeMoveDepth{4};
+    static Game::MakeMoveBenchmark makeMoveBenchmark{};
+    ImGui::InputInt("Perft depth", &makeMoveDepth);
+    if (ImGui::Button("Make/unmake vs copy-make"))
+      makeMoveBenchmark = game->benchmarkMakeMove(makeMoveDepth);
+    ImGui::Text("Moves made: %llu", makeMoveBenchmark.moves);
+    ImGui::Text("Make/unmake: %.1f ns/move", makeMoveBenchmark.makeUnmakeNanoseconds);
+    ImGui::Text("Copy-make: %.1f ns/move", makeMoveBenchmark.copyMakeNanoseconds);
+    if (!makeMoveBenchmark.hashesMatch)
+      ImGui::TextColored(ImVec4(1, 0.3f, 0.3f, 1), "Hashes differ!");
+
+    static int sliderDepth{3};
+    static unsigned int sliderIterations{100};
+    static Game::SliderBenchmark sliderBenchmark{};
+    ImGui::InputInt("Slider perft depth", &sliderDepth);
+    ImGui::InputScalar("Slider iterations", ImGuiDataType_U32, &sliderIterations);
+    if (ImGui::Button("Slider backend vs line attacks"))
+      sliderBenchmark = game->benchmarkSliders(sliderDepth, sliderIterations);
+    ImGui::Text("Lookups: %llu", sliderBenchmark.lookups);
+    ImGui::Text("%s: %.2f ns/lookup", sliderBenchmark.backend, sliderBenchmark.backendNanoseconds);
+    ImGui::Text("Line attacks: %.2f ns/lookup", sliderBenchmark.lineAttacksNanoseconds);
+  }
+
   if (open_fen_import)
     ImGui::OpenPopup("Import FEN");
   if (ImGui::BeginPopupModal("Import FEN", &open_fen_import)) {
@@ -1,13 +1,15 @@
 #include "game.hpp"
 
+#include <bit>
+#include <chrono>
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
-#include <forward_list>
 #include <imgui.h>
 #include <imgui_impl_sdl3.h>
 #include <imgui_impl_sdlrenderer3.h>
 #include <map>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -19,7 +21,10 @@
 #include "SDL3_image/SDL_image.h"
 
 #include "chess/board.hpp"
+#include "chess/board/lineAttacks.hpp"
+#include "chess/position.hpp"
 #include "chess/move.hpp"
+#include "chess/moveList.hpp"
 #include "chess/piece.hpp"
 
 static SDL_Texture *whitePawn;
@@ -40,9 +45,12 @@ namespace Debugger {
 unsigned long long Game::perft(int depth) {
   if (depth == 0)
     return 1ULL;
+  // bulk count the leaves, there's no need to make the last moves just to count them
+  if (depth == 1)
+    return board.countLegalMoves();
 
   unsigned long long moves{0};
-  std::forward_list<Chess::Move> legalMoves = board.getAllLegalMoves();
+  Chess::MoveList legalMoves = board.getAllLegalMoves();
   for (auto legalMove : legalMoves) {
     board.makeMove(legalMove);
     moves += perft(depth - 1);
@@ -55,19 +63,143 @@ std::map<Chess::Move, unsigned long long> Game::perftDivide(int depth) {
   if (depth == 0)
     return divided;
 
-  std::forward_list<Chess::Move> moves = board.getAllLegalMoves();
+  Chess::MoveList moves = board.getAllLegalMoves();
+  board.beginSearch();
   for (auto move : moves) {
     board.makeMove(move);
     divided[move] = perft(depth - 1);
     board.unmakeMove();
   }
+  board.endSearch();
   return divided;
 }
 
+void Game::collectMoveSequence(int depth, std::vector<Chess::Move> &sequence) {
+  if (depth == 0)
+    return;
+  for (const Chess::Move &move : board.getAllLegalMoves()) {
+    sequence.push_back(move);
+    board.makeMove(move);
+    collectMoveSequence(depth - 1, sequence);
+    board.unmakeMove();
+    sequence.push_back(Chess::Move::Empty);
+  }
+}
+
+Game::MakeMoveBenchmark Game::benchmarkMakeMove(int depth) {
+  MakeMoveBenchmark result{};
+  if (depth < 1 || depth >= static_cast<int>(Chess::BoardUtils::StateHistory::maxSearchPly))
+    return result;
+
+  std::vector<Chess::Move> sequence{};
+  board.beginSearch();
+  collectMoveSequence(depth, sequence);
+  result.moves = sequence.size() / 2;
+  if (result.moves == 0) {
+    board.endSearch();
+    return result;
+  }
+
+  // hashes of every position reached, xored together - checks both sides and keeps the work from being dropped
+  uint64_t makeUnmakeHashes{0};
+  auto start = std::chrono::steady_clock::now();
+  for (const Chess::Move &move : sequence) {
+    if (move == Chess::Move::Empty)
+      board.unmakeMove();
+    else {
+      board.makeMove(move);
+      makeUnmakeHashes ^= board.getHash();
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  board.endSearch();
+  result.makeUnmakeNanoseconds = std::chrono::duration<double, std::nano>(end - start).count() / result.moves;
+
+  // one position per ply, a child is written over its parent's copy
+  std::vector<Chess::Position> positions(depth + 1);
+  positions[0] = board.getPosition();
+  size_t ply{0};
+  uint64_t copyMakeHashes{0};
+  start = std::chrono::steady_clock::now();
+  for (const Chess::Move &move : sequence) {
+    if (move == Chess::Move::Empty)
+      ply--;
+    else {
+      positions[ply + 1] = positions[ply];
+      positions[++ply].makeMove(move);
+      copyMakeHashes ^= positions[ply].hash;
+    }
+  }
+  end = std::chrono::steady_clock::now();
+  result.copyMakeNanoseconds = std::chrono::duration<double, std::nano>(end - start).count() / result.moves;
+
+  result.hashesMatch = makeUnmakeHashes == copyMakeHashes;
+  return result;
+}
+
+void Game::collectSliderLookups(int depth, std::vector<SliderLookup> &lookups) {
+  const uint64_t occupancy = board.bitboards.getAllPiecesBitboard();
+  const uint64_t queens = board.bitboards.getPieceTypeBitboard(Chess::Piece::Queen);
+  for (uint64_t diagonal = board.bitboards.getPieceTypeBitboard(Chess::Piece::Bishop) | queens; diagonal;
+       diagonal &= diagonal - 1)
+    lookups.push_back({occupancy, static_cast<uint8_t>(std::countr_zero(diagonal)), false});
+  for (uint64_t orthogonal = board.bitboards.getPieceTypeBitboard(Chess::Piece::Rook) | queens; orthogonal;
+       orthogonal &= orthogonal - 1)
+    lookups.push_back({occupancy, static_cast<uint8_t>(std::countr_zero(orthogonal)), true});
+
+  if (depth == 0)
+    return;
+  for (const Chess::Move &move : board.getAllLegalMoves()) {
+    board.makeMove(move);
+    collectSliderLookups(depth - 1, lookups);
+    board.unmakeMove();
+  }
+}
+
+Game::SliderBenchmark Game::benchmarkSliders(int depth, unsigned int iterations) {
+  SliderBenchmark result{};
+#if defined(PEXT_BITBOARDS)
+  result.backend = "pext";
+#elif defined(LINE_ATTACKS)
+  result.backend = "lines";
+#else
+  result.backend = "magic";
+#endif
+
+  std::vector<SliderLookup> lookups{};
+  board.beginSearch();
+  collectSliderLookups(depth, lookups);
+  board.endSearch();
+  if (lookups.empty() || iterations == 0)
+    return result;
+  result.lookups = static_cast<unsigned long long>(lookups.size()) * iterations;
+
+  volatile uint64_t sink{0};
+  uint64_t attacks{0};
+
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned int i{0}; i < iterations; i++)
+    for (const SliderLookup &lookup : lookups)
+      attacks ^= lookup.orthogonal ? board.orthogonalAttacks(lookup.occupancy, lookup.square)
+                                   : board.diagonalAttacks(lookup.occupancy, lookup.square);
+  auto end = std::chrono::steady_clock::now();
+  sink = sink + attacks;
+  result.backendNanoseconds = std::chrono::duration<double, std::nano>(end - start).count() / result.lookups;
+
+  start = std::chrono::steady_clock::now();
+  for (unsigned int i{0}; i < iterations; i++)
+    for (const SliderLookup &lookup : lookups)
+      attacks ^= lookup.orthogonal ? Chess::LineAttacks::orthogonalAttacks(lookup.occupancy, lookup.square)
+                                   : Chess::LineAttacks::diagonalAttacks(lookup.occupancy, lookup.square);
+  end = std::chrono::steady_clock::now();
+  sink = sink + attacks;
+  result.lineAttacksNanoseconds = std::chrono::duration<double, std::nano>(end - start).count() / result.lookups;
+
+  return result;
+}
+
 Game::PerftData Game::startPerft(int depth) {
-  auto movesList(board.getAllLegalMoves());
-  std::vector<Chess::Move> moves(movesList.begin(), movesList.end());
-  Game::PerftData data{true, depth, {{-1, moves}}};
+  Game::PerftData data{true, depth, {{-1, board.getAllLegalMoves()}}};
   return data;
 }
 
@@ -91,13 +223,12 @@ bool Game::stepPerft(PerftData &data) {
     // advance to next sibling
     board.unmakeMove();
     // [i cannot believe this is legal C++ code]
-    auto move = data.moveList.back().moves.at(++data.moveList.back().index);
+    auto move = data.moveList.back().moves[++data.moveList.back().index];
     board.makeMove(move);
   } else {
     // if not at max depth, deepen by one layer
     if (data.moveList.size() < data.depth) {
-      auto movesList = board.getAllLegalMoves();
-      std::vector<Chess::Move> moves(movesList.begin(), movesList.end());
+      Chess::MoveList moves = board.getAllLegalMoves();
       int index{-1};
       if (moves.size() > 0) {
         auto &move = moves.front();
@@ -111,7 +242,7 @@ bool Game::stepPerft(PerftData &data) {
 
     // we haven't deepened at this point, advance to next sibling
     board.unmakeMove();
-    auto &move = data.moveList.back().moves.at(++data.moveList.back().index);
+    auto &move = data.moveList.back().moves[++data.moveList.back().index];
     board.makeMove(move);
   }
   return false;
@@ -182,7 +313,7 @@ void Game::setSelectedSquare(unsigned char square) {
     selectedSquare = noSelection;
   }
   selectedSquare = square;
-  generateLegalMovesForSquare();
+  generateLegalTargetsForSquare();
 }
 
 void Game::render(SDL_Renderer *renderer) {
@@ -258,7 +389,7 @@ void Game::render(SDL_Renderer *renderer) {
   }
   }
 
-  const Chess::Board::PieceIndex::Entry *pieceIndex{nullptr};
+  std::span<const uint8_t> pieceIndex{};
   if (renderIndexes != None) {
     Chess::Piece::Color indexColor;
     switch (renderIndexes) {
@@ -314,7 +445,7 @@ void Game::render(SDL_Renderer *renderer) {
     }
 
     if (renderIndexes != None)
-      pieceIndex = board.pieceIndex.getIndex(Chess::Piece(indexColor, indexType));
+      pieceIndex = board.pieceIndex.getSquares(indexType, indexColor);
   }
 
   uint64_t selectedBitboard{0};
@@ -459,10 +590,10 @@ void Game::render(SDL_Renderer *renderer) {
     }
   }
 
-  const auto legalMoves = getLegalMovesForSelectedSquare();
-  for (auto move : legalMoves) {
-    int row = 7 - move.endSquare() / 8;
-    int col = move.endSquare() % 8;
+  for (uint64_t targets{getLegalTargetsForSelectedSquare()}; targets; targets &= targets - 1) {
+    int target = std::countr_zero(targets);
+    int row = 7 - target / 8;
+    int col = target % 8;
     SDL_FRect destRect = {static_cast<float>(5 + col * 30), static_cast<float>(5 + row * 30), 30, 30};
     SDL_RenderTexture(renderer, moveableSquare, NULL, &destRect);
   }
@@ -479,15 +610,14 @@ void Game::render(SDL_Renderer *renderer) {
   SDL_RenderDebugText(renderer, 250, 15, ("Selected square: " + std::to_string((int)selectedSquare)).c_str());
 
   int i{0};
-  while (pieceIndex != nullptr) {
-    int row = 7 - pieceIndex->square / 8;
-    int col = pieceIndex->square % 8;
+  for (const uint8_t square : pieceIndex) {
+    int row = 7 - square / 8;
+    int col = square % 8;
     SDL_FRect destRect = {static_cast<float>(5 + col * 30), static_cast<float>(5 + row * 30), 30, 30};
     SDL_SetRenderDrawColor(renderer, 0, 255, 0, 100);
     SDL_RenderFillRect(renderer, &destRect);
     SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
     SDL_RenderDebugTextFormat(renderer, destRect.x, destRect.y, "%d", i++);
-    pieceIndex = pieceIndex->next;
   }
 }
 
@@ -501,11 +631,9 @@ void Game::handleMouseDown(SDL_MouseButtonEvent *event) {
   unsigned char square = col + row * 8;
 
   if (event->button == SDL_BUTTON_LEFT) {
-    for (auto move : getLegalMovesForSelectedSquare()) {
-      if (move.endSquare() == square) {
-        makeMove(move);
-        return;
-      }
+    if (getLegalTargetsForSelectedSquare() & Chess::Board::bitmaskForSquare(square)) {
+      makeMove(selectedSquare, square);
+      return;
     }
 
     Chess::Piece piece = board.getPiece(square);
@@ -546,6 +674,6 @@ void Game::handleMouseUp(SDL_MouseButtonEvent *event) {
 void Game::resetBoard() {
   board = Chess::Board();
   selectedSquare = noSelection;
-  generateLegalMovesForSquare();
+  generateLegalTargetsForSquare();
 }
 }; // namespace Debugger
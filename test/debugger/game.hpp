@@ -9,6 +9,7 @@
 
 #include "chess/board.hpp"
 #include "chess/move.hpp"
+#include "chess/moveList.hpp"
 
 namespace Debugger {
 class Game {
@@ -20,25 +21,32 @@ private:
 
   unsigned char selectedSquare{noSelection};
 
-  std::vector<Chess::Move> legalMovesForSelectedSquare{};
+  uint64_t legalTargetsForSelectedSquare{0};
   bool dragging{false};
   struct DragPosition {
     int dx;
     int dy;
   } dragPosition{0, 0};
 
-  void generateLegalMovesForSquare() {
-    legalMovesForSelectedSquare.clear();
-    if (selectedSquare != noSelection) {
-      auto moves = board.getLegalMovesForSquare(selectedSquare);
-      legalMovesForSelectedSquare.insert(legalMovesForSelectedSquare.begin(), moves.begin(), moves.end());
-    }
+  void generateLegalTargetsForSquare() {
+    legalTargetsForSelectedSquare = selectedSquare != noSelection ? board.getLegalTargets(selectedSquare) : 0;
   }
 
+  /// @brief a slider lookup as search would make it
+  struct SliderLookup {
+    uint64_t occupancy;
+    uint8_t square;
+    bool orthogonal;
+  };
+  /// @brief record the lookups every slider of the position would make, then recurse into each legal move
+  void collectSliderLookups(int depth, std::vector<SliderLookup> &lookups);
+  /// @brief record a depth first walk of the perft tree, Move::Empty marking each unmake
+  void collectMoveSequence(int depth, std::vector<Chess::Move> &sequence);
+
 public:
   struct PerftMoveList {
     int index;
-    std::vector<Chess::Move> moves;
+    Chess::MoveList moves;
   };
   struct PerftData {
     bool running{false};
@@ -51,6 +59,33 @@ public:
   bool stepPerft(PerftData &data);
   void stopPerft(PerftData &data);
 
+  struct MakeMoveBenchmark {
+    unsigned long long moves{0};
+    double makeUnmakeNanoseconds{0};
+    double copyMakeNanoseconds{0};
+    /// @brief both reached the same hash after every move
+    bool hashesMatch{true};
+  };
+  /// @brief time only the state updates - make/unmake on the board against copy-make on a Position
+  /// the moves of a perft tree from the current position are generated once up front, then both replay them
+  /// @param depth depth of the perft tree
+  /// @return average time per move made (and unmade) for each
+  MakeMoveBenchmark benchmarkMakeMove(int depth);
+
+  struct SliderBenchmark {
+    /// @brief backend the board was built with (SLIDER_BACKEND)
+    const char *backend{""};
+    unsigned long long lookups{0};
+    double backendNanoseconds{0};
+    double lineAttacksNanoseconds{0};
+  };
+  /// @brief time slider lookups, the board's backend against the table-free line attacks
+  /// the occupancies are those of every bishop, rook and queen in a perft tree from the current position
+  /// @param depth depth of the perft tree to take occupancies from
+  /// @param iterations how many times to go through the occupancies
+  /// @return average time per lookup for each
+  SliderBenchmark benchmarkSliders(int depth, unsigned int iterations);
+
   enum RenderDebugInfo {
     None,
     All,
@@ -86,14 +121,19 @@ public:
 
   void makeMove(const Chess::Move &move) {
     selectedSquare = noSelection; // reset selected square
-    generateLegalMovesForSquare();
+    generateLegalTargetsForSquare();
     board.makeMove(move);
   };
+  bool makeMove(uint8_t fromSquare, uint8_t toSquare) {
+    selectedSquare = noSelection; // reset selected square
+    generateLegalTargetsForSquare();
+    return board.makeMove(fromSquare, toSquare);
+  }
 
   void unmakeMove() {
     board.unmakeMove();
     selectedSquare = noSelection;
-    generateLegalMovesForSquare();
+    generateLegalTargetsForSquare();
   }
 
   static const unsigned char noSelection = 65;
@@ -101,7 +141,7 @@ public:
   void setSelectedSquare(unsigned char square);
   void setSelectedSquare(int row, int col) { setSelectedSquare(col + row * 8); }
 
-  const std::vector<Chess::Move> &getLegalMovesForSelectedSquare() const { return legalMovesForSelectedSquare; }
+  uint64_t getLegalTargetsForSelectedSquare() const { return legalTargetsForSelectedSquare; }
 
   void handleKeyboard(SDL_KeyboardEvent *event) {}
   void handleMouseDown(SDL_MouseButtonEvent *event);
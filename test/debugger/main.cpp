@@ -16,6 +16,7 @@
 #include "imgui_impl_sdl3.h"
 #include "imgui_impl_sdlrenderer3.h"
 
+#include "chess/board.hpp"
 #include "debugger/debug.hpp"
 #include "debugger/game.hpp"
 
@@ -79,6 +80,7 @@ int main(int argc, char **argv) {
   SDL_SetDefaultTextureScaleMode(renderer, SDL_ScaleMode::SDL_SCALEMODE_PIXELART);
   SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
 
+  Chess::Board::loadSliderTables("assets/");
   Debugger::Game game;
 
   if (argc > 1) {
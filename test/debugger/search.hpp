@@ -5,13 +5,14 @@
 
 #include "chess/board.hpp"
 #include "chess/move.hpp"
+#include "chess/moveList.hpp"
 
 class Search {
 protected:
   int totalMoves{0};
   int currentDepth{0};
   Chess::Board &board;
-  std::vector<std::vector<Chess::Move>> moveTree;
+  std::vector<Chess::MoveList> moveTree;
   std::vector<int> currentMoveIndex;
   std::vector<int> totalMovesAtDepth;
   bool searchStopped{false};
@@ -33,8 +34,7 @@ public:
     // if not, continue deepening search
     if (currentDepth < searchPly) {
       // gather legal moves and add them to tree
-      std::vector<Chess::Move> legalMoves = board.getLegalMoves();
-      moveTree.push_back(legalMoves);
+      moveTree.push_back(board.getAllLegalMoves());
 
       // add index for move counting at depth
       totalMovesAtDepth.push_back(0);
@@ -66,7 +66,7 @@ public:
     // common logic for proceeding to next branch
     board.unmakeMove();
     Chess::Move nextMove = moveTree.back()[++currentMoveIndex.back()];
-    if (!board.makeMove(nextMove.startSquare(), nextMove.endSquare())) {
+    if (!board.makeMove(nextMove.startSquare(), nextMove.endSquare(), nextMove.promotionType())) {
       throw std::runtime_error("Failed to make move during search: " +
                                nextMove.getNotation(board.getPiece(nextMove.startSquare())));
     }
@@ -1,13 +1,18 @@
 #include <array>
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <map>
+#include <string>
 #include <unistd.h>
 #include <utility>
+#include <vector>
 
 #include "bitboards.hpp"
+#include "chess/board/magicBitboards.hpp"
+#include "packing.hpp"
 
 struct MagicMapEntry {
   int shift{0};
@@ -15,6 +20,29 @@ struct MagicMapEntry {
   std::map<uint64_t, uint64_t> moveMap;
 };
 
+/// @brief pack one direction's moveset slices and build the asset entry of every square
+/// @param name "orth" or "diag", for the size report
+/// @return the movesets, and the entries indexing into them
+std::pair<std::vector<uint64_t>, std::array<Chess::MagicBitboards::AssetEntry, 64>>
+buildDirection(const std::string &name, const std::array<uint64_t, 64> &masks,
+               const std::array<const MagicMapEntry *, 64> &magics) {
+  std::array<const std::map<uint64_t, uint64_t> *, 64> moveMaps{};
+  std::array<int, 64> shifts{};
+  for (int i{0}; i < 64; i++) {
+    moveMaps[i] = &magics[i]->moveMap;
+    shifts[i] = magics[i]->shift;
+  }
+  PackedMovesets packed = packMovesets(moveMaps, shifts);
+
+  std::array<Chess::MagicBitboards::AssetEntry, 64> entries{};
+  for (int i{0}; i < 64; i++)
+    entries[i] = {masks[i], magics[i]->magic, packed.offsets[i], static_cast<uint32_t>(magics[i]->shift)};
+
+  std::printf("%s: %zu movesets (%.3f KB), %zu without overlapping\n", name.c_str(), packed.movesets.size(),
+              packed.movesets.size() * 8 / 1000.0f, packed.unpackedLength);
+  return {std::move(packed.movesets), entries};
+}
+
 int main(int argc, char **argv) {
   char opt;
   std::ifstream input;
@@ -26,7 +54,7 @@ int main(int argc, char **argv) {
       break;
     case 'o':
       std::remove(optarg);
-      output = std::ofstream(optarg);
+      output = std::ofstream(optarg, std::ios::binary);
       break;
     }
   }
@@ -75,124 +103,38 @@ int main(int argc, char **argv) {
     input.ignore(2);
   }
 
-  /*
-  format:
-  uint64_t orthMagics[64] = {orth magic, orth magic, ... (x 64)}
-  uint8_t orthShifts[64] = {orth shift, orth shift, ... (x 64)}
-  uint64_t allOrthMovesets[] = {bitboard, bitboard, ...}
-  uint64_t *orthMovesets[64] = {numx + orth index, nums + orth index, ... (x 64)}
-  (repeat for diagonal)
-  */
-  // write magics
-  output << "/* code generated by magic-conversion, do not touch! */\n#include <cinttypes>\n#include "
-            "\"magicBitboards.hpp\"\nconst uint64_t Chess::MagicBitboards::orthMasks[64] = {";
-
-  // output masks
-  for (int i{0}; i < 64; i++) {
-    output << orthOccupancyMasks[i] << "ull";
-    if (i < 63)
-      output << ",";
-  }
-  output << "};\nconst uint64_t Chess::MagicBitboards::orthMagics[64] = {";
-
-  // output orthogonal magics
+  // layout is described next to AssetHeader
+  std::array<const MagicMapEntry *, 64> orthMagics{};
+  std::array<const MagicMapEntry *, 64> diagMagics{};
   for (int i{0}; i < 64; i++) {
-    output << magicMap[i].first.magic << "ull";
-    if (i < 63)
-      output << ",";
-  }
-  output << "};\nconst uint8_t Chess::MagicBitboards::orthShifts[64] = {";
-
-  // orthogonal shift values
-  for (int i{0}; i < 64; i++) {
-    output << magicMap[i].first.shift << "u";
-    if (i < 63)
-      output << ",";
-  }
-  output << "};\nconst uint64_t allOrthMovesets[] = {";
-
-  // create all orthogonal moveset list
-  std::array<uint32_t, 63> orthOffsets{0};
-  uint32_t currentOffset{0};
-  for (int i{0}; i < 64; i++) {
-    // set offsets for all other than first square, unneeded
-    if (i > 0)
-      orthOffsets[i - 1] = currentOffset;
-
-    const auto &movesets = magicMap[i].first.moveMap;
-    const uint32_t maxIndex = movesets.rbegin()->first;
-    for (uint64_t j{0}; j <= maxIndex; j++) {
-      if (movesets.contains(j))
-        output << movesets.at(j) << "ull";
-      else
-        output << "0ull";
-      if (j < maxIndex)
-        output << ",";
-    }
-
-    // set first index of next set of movesets to one past last index (trust me)
-    currentOffset += maxIndex + 1;
-    if (i < 63)
-      output << ",\n";
-  }
-
-  // output individual square orth movesets list pointers
-  output << "};\nconst uint64_t *Chess::MagicBitboards::orthMovesets[64] = {allOrthMovesets,";
-  // pointer arithmatic shenanigans
-  for (int i{0}; i < 63; i++) {
-    output << "allOrthMovesets + " << orthOffsets[i];
-    if (i < 62)
-      output << ",";
-  }
-
-  // output diagonal masks
-  output << "};\nconst uint64_t Chess::MagicBitboards::diagMasks[64] = {";
-  for (int i{0}; i < 64; i++) {
-    output << diagOccupancyMasks[i] << "ull";
-    if (i < 63)
-      output << ",";
-  }
-
-  output << "};\nconst uint64_t Chess::MagicBitboards::diagMagics[64] = {";
-  // yeah so just do all this again for diagonals ig
-  for (int i{0}; i < 64; i++) {
-    output << magicMap[i].second.magic << "ull";
-    if (i < 63)
-      output << ",";
-  }
-  output << "};\nconst uint8_t Chess::MagicBitboards::diagShifts[64] = {";
-  for (int i{0}; i < 64; i++) {
-    output << magicMap[i].second.shift << "u";
-    if (i < 63)
-      output << ",";
-  }
-  output << "};\nconst uint64_t allDiagMovesets[] = {";
-  std::array<uint32_t, 63> diagOffsets{0};
-  currentOffset = 0;
-  for (int i{0}; i < 64; i++) {
-    if (i > 0)
-      diagOffsets[i - 1] = currentOffset;
-
-    const auto &movesets = magicMap[i].second.moveMap;
-    const uint32_t maxIndex = movesets.rbegin()->first;
-    for (uint64_t j{0}; j <= maxIndex; j++) {
-      if (movesets.contains(j))
-        output << movesets.at(j) << "ull";
-      else
-        output << "0ull";
-      if (j < maxIndex)
-        output << ",";
-    }
-
-    currentOffset += maxIndex + 1;
-    if (i < 63)
-      output << ",\n";
-  }
-  output << "};\nconst uint64_t *Chess::MagicBitboards::diagMovesets[64] = {allDiagMovesets,";
-  for (int i{0}; i < 63; i++) {
-    output << "allDiagMovesets+" << diagOffsets[i];
-    if (i < 62)
-      output << ",";
+    orthMagics[i] = &magicMap[i].first;
+    diagMagics[i] = &magicMap[i].second;
   }
-  output << "};\n";
+  const auto [orthMovesets, orthEntries] = buildDirection("orth", orthOccupancyMasks, orthMagics);
+  const auto [diagMovesets, diagEntries] = buildDirection("diag", diagOccupancyMasks, diagMagics);
+
+  using namespace Chess::MagicBitboards;
+  AssetHeader header{};
+  std::memcpy(header.tag, assetTag, sizeof(assetTag));
+  header.version = assetVersion;
+  header.orthEntries = sizeof(AssetHeader);
+  header.diagEntries = header.orthEntries + sizeof(orthEntries);
+  header.orthMovesets = header.diagEntries + sizeof(diagEntries);
+  header.diagMovesets = header.orthMovesets + orthMovesets.size() * sizeof(uint64_t);
+  header.size = header.diagMovesets + diagMovesets.size() * sizeof(uint64_t);
+
+  // everything after the header, as the words the checksum runs over
+  std::vector<uint64_t> body((header.size - sizeof(AssetHeader)) / sizeof(uint64_t));
+  auto place = [&](uint32_t offset, const void *data, size_t size) {
+    std::memcpy(reinterpret_cast<unsigned char *>(body.data()) + offset - sizeof(AssetHeader), data, size);
+  };
+  place(header.orthEntries, orthEntries.data(), sizeof(orthEntries));
+  place(header.diagEntries, diagEntries.data(), sizeof(diagEntries));
+  place(header.orthMovesets, orthMovesets.data(), orthMovesets.size() * sizeof(uint64_t));
+  place(header.diagMovesets, diagMovesets.data(), diagMovesets.size() * sizeof(uint64_t));
+  header.checksum = checksum(body.data(), body.size());
+
+  output.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  output.write(reinterpret_cast<const char *>(body.data()), body.size() * sizeof(uint64_t));
+  std::printf("wrote %u bytes\n", header.size);
 }
@@ -32,6 +32,7 @@ s - saves to a file (comma separated values, newline separated lists)
 #include <vector>
 
 #include "bitboards.hpp"
+#include "packing.hpp"
 #include "search.hpp"
 
 std::atomic_bool terminate{false};
@@ -77,6 +78,23 @@ void saveToFile(const std::string &filename, std::array<std::pair<MagicMapEntry,
   }
 }
 
+/// @brief print the moveset table sizes once magic-conversion overlaps the slices
+void printPackedSize(std::array<std::pair<MagicMapEntry, MagicMapEntry>, 64> &magicMap) {
+  std::array<const std::map<uint64_t, uint64_t> *, 64> orthMoveMaps{}, diagMoveMaps{};
+  std::array<int, 64> orthShifts{}, diagShifts{};
+  for (int i{0}; i < 64; i++) {
+    orthMoveMaps[i] = &magicMap[i].first.moveMap;
+    diagMoveMaps[i] = &magicMap[i].second.moveMap;
+    orthShifts[i] = magicMap[i].first.shift;
+    diagShifts[i] = magicMap[i].second.shift;
+  }
+  const PackedMovesets orth = packMovesets(orthMoveMaps, orthShifts);
+  const PackedMovesets diag = packMovesets(diagMoveMaps, diagShifts);
+  std::cout << std::format("Packed movesets: orth {:.3f} KB, diag {:.3f} KB", orth.movesets.size() * 8 / 1000.0f,
+                           diag.movesets.size() * 8 / 1000.0f)
+            << std::endl;
+}
+
 int main(int argc, char **argv) {
   std::cout << std::unitbuf;
   char opt;
@@ -151,11 +169,13 @@ int main(int argc, char **argv) {
     auto &[orthMap, diagMap] = magicMap[i];
 
     int orthPossibilityBits = std::popcount(orthOccupancyMasks[i]);
-    auto orthSearch = std::make_shared<MagicSearch>(doOrthogonal, orthOccupancySets[i], orthMap.magic, orthMap.shift);
+    auto orthSearch = std::make_shared<MagicSearch>(doOrthogonal, orthOccupancySets[i], 64 - orthPossibilityBits,
+                                                    orthMap.magic, orthMap.shift);
     orthBaselineLength += (1ul << orthPossibilityBits);
 
     int diagPossibilityBits = std::popcount(diagOccupancyMasks[i]);
-    auto diagSearch = std::make_shared<MagicSearch>(doDiagonal, diagOccupancySets[i], diagMap.magic, diagMap.shift);
+    auto diagSearch = std::make_shared<MagicSearch>(doDiagonal, diagOccupancySets[i], 64 - diagPossibilityBits,
+                                                    diagMap.magic, diagMap.shift);
     diagBaselineLength += (1ul << diagPossibilityBits);
 
     magicSearches.emplace_back(orthSearch, diagSearch);
@@ -361,6 +381,7 @@ int main(int argc, char **argv) {
 
     std::cout << "Stopped, saving magics to file '" << outputFilename << "'...\n";
     saveToFile(outputFilename, magicMap);
+    printPackedSize(magicMap);
   } else {
     std::signal(SIGTERM, signalHandler);
     std::signal(SIGINT, signalHandler);
@@ -428,5 +449,6 @@ int main(int argc, char **argv) {
     }
     std::cout << "Stopped, saving magics to file '" << outputFilename << "'..." << std::endl;
     saveToFile(outputFilename, magicMap);
+    printPackedSize(magicMap);
   }
 }
@@ -0,0 +1,51 @@
+#include "packing.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <numeric>
+#include <vector>
+
+PackedMovesets packMovesets(const std::array<const std::map<uint64_t, uint64_t> *, 64> &moveMaps,
+                            const std::array<int, 64> &shifts) {
+  PackedMovesets packed{};
+  std::array<size_t, 64> lengths{};
+  for (int i{0}; i < 64; i++) {
+    lengths[i] = moveMaps[i]->empty() ? 0 : size_t{1} << (64 - shifts[i]);
+    packed.unpackedLength += lengths[i];
+  }
+
+  // big slices first, the small ones can usually be tucked into their holes afterwards
+  std::array<int, 64> order{};
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return lengths[a] > lengths[b]; });
+
+  auto &movesets = packed.movesets;
+  for (int square : order) {
+    const auto &moveMap = *moveMaps[square];
+    size_t offset{0};
+    for (;; offset++) {
+      bool fits{true};
+      for (const auto &[index, moveset] : moveMap) {
+        if (offset + index >= movesets.size())
+          break; // the map is sorted, everything after this is past the end too
+        const uint64_t existing = movesets[offset + index];
+        if (existing != 0 && existing != moveset) {
+          fits = false;
+          break;
+        }
+      }
+      if (fits)
+        break;
+    }
+
+    // padded with holes past the last used entry, for the next slices to fill
+    movesets.resize(std::max(movesets.size(), offset + lengths[square]));
+    for (const auto &[index, moveset] : moveMap)
+      movesets[offset + index] = moveset;
+    packed.offsets[square] = offset;
+  }
+  return packed;
+}
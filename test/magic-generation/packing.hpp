@@ -0,0 +1,35 @@
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+/*
+  every square's movesets are a slice of one big array, indexed by the magic. most indices in a
+  slice are never looked up (the magic doesn't map any occupancy there), and are left as 0 - a
+  slider always attacks at least one square, so 0 can't be a real moveset.
+
+  those holes let slices overlap: a slice can start anywhere its used entries land either on a
+  hole or on an identical moveset, and the lookup is still exactly `movesets[square][index]`.
+
+  with the usual fancy sizing (2^popcount(mask) indices) a slice only has holes when its magic
+  leaves some indices unused, mostly at either end - magic-generation keeps looking for magics
+  with a narrower used span once it has one, so there is something to overlap. the table is
+  padded so every slice's whole index range, 2^(64 - shift), stays inside it, which is what
+  the loader checks.
+*/
+
+struct PackedMovesets {
+  /// @brief all slices, overlapped
+  std::vector<uint64_t> movesets;
+  /// @brief where each square's slice starts in movesets
+  std::array<uint32_t, 64> offsets;
+  /// @brief entries the slices would take up laid back to back, at their full length
+  size_t unpackedLength;
+};
+
+/// @brief place each square's slice (largest first) at the first offset it fits at
+/// @param moveMaps index -> moveset for each square, only indices that are actually used
+/// @param shifts each square's magic shift, the table is padded to fit 2^(64 - shift) entries from every offset
+PackedMovesets packMovesets(const std::array<const std::map<uint64_t, uint64_t> *, 64> &moveMaps,
+                            const std::array<int, 64> &shifts);
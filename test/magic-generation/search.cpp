@@ -1,33 +1,51 @@
 #include "search.hpp"
 
+#include <algorithm>
 #include <cstdint>
-#include <cstdlib>
 #include <map>
 #include <mutex>
+#include <random>
+
+/// @brief distance from the lowest to the highest index the magic maps an occupancy to, plus one
+static uint64_t indexSpan(const std::vector<std::pair<uint64_t, uint64_t>> &occupancySets, uint64_t magic,
+                          int shift) {
+  uint64_t lowest{UINT64_MAX}, highest{0};
+  for (auto &occupancySet : occupancySets) {
+    const uint64_t index = (occupancySet.first * magic) >> shift;
+    lowest = std::min(lowest, index);
+    highest = std::max(highest, index);
+  }
+  return highest - lowest + 1;
+}
 
 void MagicSearch::entrypoint() {
+  std::mt19937_64 random{std::random_device{}()};
+  if (bestMagic != 0)
+    bestSpan = indexSpan(occupancySets, bestMagic, bestShift);
   // conduct a search for magic numbers
   while (!shouldStop) {
-    // generate random magic number
-    uint64_t magic = (static_cast<uint64_t>(rand()) << 32) + rand();
+    // generate random magic number, magics with few bits set work far more often
+    uint64_t magic = random() & random() & random();
 
     bool succeeded{true};
     int collisions{0};
-    // start at initial shift value (minimum possible)
+    // start at the shift of a table with one slot per occupancy (2^popcount(mask) long), or at the best shift -
+    // a magic that only matches the best shift is still kept if its used indices are closer together
     // stop if
     //   search stopped
     //   shift is less than best shift (more bits)
+    //   shift is the best shift, and the used indices aren't any closer together
     //   last shift didn't fail
     // ergo, continue if
     //    search not stopped
-    //    shift is more than best shift
+    //    shift is at least best shift
     //    last shift failed
 
     // outputStream << "Testing magic: 0x" << std::setw(16) << std::hex << magic << "\n";
     // std::cout << outputStream.str();
     // outputStream.clear();
 
-    for (int shift{bestShift + 1}; !shouldStop && succeeded && shift < 64; shift++) {
+    for (int shift{std::max(bestShift, minShift)}; !shouldStop && succeeded && shift < 64; shift++) {
       collisions = 0;
       // start search for this shift
       std::map<uint64_t, uint64_t> moveMap{};
@@ -48,12 +66,16 @@ void MagicSearch::entrypoint() {
       }
       // if this set didn't fail!
       if (succeeded) {
+        const uint64_t span = moveMap.rbegin()->first - moveMap.begin()->first + 1;
+        if (shift == bestShift && span >= bestSpan)
+          continue;
         // outputStream << "Shift " << std::dec << shift << " succeeded!\n";
         // std::cout << outputStream.str();
         // outputStream.clear();
         std::lock_guard lock(valueMutex);
         bestMagic = magic;
         bestShift = shift;
+        bestSpan = span;
         bestMoveMap = moveMap;
         bestMapCollisions = collisions;
         newMagicFound = true;
@@ -10,7 +10,11 @@ class MagicSearch {
   std::thread thisThread;
   void entrypoint();
   const std::vector<std::pair<uint64_t, uint64_t>> &occupancySets;
+  // most index bits a magic may use - one per bit of the occupancy mask, the usual fancy magic sizing
+  const int minShift;
   std::atomic_bool shouldStop;
+  // lowest to highest used index of the best magic, a narrower one at the same shift packs better
+  uint64_t bestSpan{UINT64_MAX};
 
 public:
   std::atomic_bool newMagicFound{false};
@@ -26,9 +30,11 @@ public:
       thisThread.join();
   }
 
-  MagicSearch(bool start, const std::vector<std::pair<uint64_t, uint64_t>> &occupancySets, uint64_t bestMagic,
-              int bestShift)
-      : shouldStop{!start}, occupancySets{occupancySets}, bestMagic{bestMagic}, bestShift{bestShift} {
+  /// @param minShift 64 - popcount(mask), magics that need more index bits than the mask has are never kept
+  MagicSearch(bool start, const std::vector<std::pair<uint64_t, uint64_t>> &occupancySets, int minShift,
+              uint64_t bestMagic, int bestShift)
+      : occupancySets{occupancySets}, minShift{minShift}, shouldStop{!start}, bestShift{bestShift},
+        bestMagic{bestMagic} {
     thisThread = std::thread(&MagicSearch::entrypoint, this);
   }
   ~MagicSearch() { stop(); }